@@ -0,0 +1,682 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename Equal = std::equal_to<Key>,
+          typename Alloc = std::allocator<std::pair<const Key, Value>>>
+class FlatUnorderedMap {
+public:
+  using NodeType = std::pair<const Key, Value>;
+  using AllocTraits = std::allocator_traits<Alloc>;
+
+  using CtrlAlloc = typename AllocTraits::template rebind_alloc<int8_t>;
+  using CtrlAllocTraits = std::allocator_traits<CtrlAlloc>;
+
+  template <bool is_const = false>
+  class _iterator {
+   public:
+    using value_type = std::conditional_t<is_const, const NodeType, NodeType>;
+    using pointer = std::conditional_t<is_const, const NodeType*, NodeType*>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<is_const, const NodeType&, NodeType&>;
+    using iterator_category = std::forward_iterator_tag;
+
+    _iterator() = default;
+
+    _iterator(const _iterator<false>& it): _ctrl(it._ctrl), _slot(it._slot) {}
+
+    _iterator<is_const>& operator=(const _iterator<false>& it) {
+      _ctrl = it._ctrl;
+      _slot = it._slot;
+      return *this;
+    }
+
+    _iterator<is_const>& operator++() {
+      ++_ctrl;
+      ++_slot;
+      _skip_free();
+      return *this;
+    }
+
+    _iterator<is_const> operator++(int) {
+      _iterator it = *this;
+      ++*this;
+      return it;
+    }
+
+    reference operator*() const {
+      return *_slot;
+    }
+
+    pointer operator->() const {
+      return _slot;
+    }
+
+    bool operator==(const _iterator<true>& it) const {
+      return _ctrl == it._ctrl;
+    }
+
+    bool operator!=(const _iterator<true>& it) const {
+      return _ctrl != it._ctrl;
+    }
+
+   private:
+    friend class FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>;
+
+    _iterator(int8_t* ctrl, NodeType* slot): _ctrl(ctrl), _slot(slot) {}
+
+    void _skip_free() {
+      while (*_ctrl < _sentinel) {
+        ++_ctrl;
+        ++_slot;
+      }
+    }
+
+    int8_t* _ctrl = nullptr;
+    NodeType* _slot = nullptr;
+  };
+
+  using iterator = _iterator<false>;
+  using const_iterator = _iterator<true>;
+
+  FlatUnorderedMap(const Alloc& alloc = Alloc(), const Hash& hash = Hash(),
+                   const Equal& equal = Equal())
+    : _alloc(alloc), _ctrl_alloc(alloc), _hash(hash), _equal_to(equal) {}
+
+  FlatUnorderedMap(const FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>& other);
+
+  FlatUnorderedMap(FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>&& other) noexcept;
+
+  ~FlatUnorderedMap();
+
+  FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>&
+    operator=(const FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>& other);
+
+  FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>&
+    operator=(FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>&& other) noexcept;
+
+  Value& operator[](const Key& key);
+
+  Value& operator[](Key&& key);
+
+  Value& at(const Key& key);
+
+  const Value& at(const Key& key) const;
+
+  iterator find(const Key& key);
+
+  const_iterator find(const Key& key) const;
+
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args);
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args);
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args);
+
+  std::pair<iterator, bool> insert(const NodeType& elem);
+
+  std::pair<iterator, bool> insert(NodeType&& elem);
+
+  template <typename InputIt>
+  void insert(InputIt first, InputIt last);
+
+  iterator erase(const_iterator pos);
+
+  iterator erase(const_iterator first, const_iterator last);
+
+  void rehash(size_t bucket_count);
+
+  void reserve(size_t count) {
+    rehash(count + count / 7 + 1);
+  }
+
+  float load_factor() const {
+    return (_capacity == 0) ? 0.0f : static_cast<float>(_size) / _capacity;
+  }
+
+  size_t bucket_count() const {
+    return _capacity;
+  }
+
+  float max_load_factor() const {
+    return 7.0f / 8.0f;
+  }
+
+  size_t size() const {
+    return _size;
+  }
+
+  iterator begin() {
+    iterator it(_ctrl, _slots);
+    it._skip_free();
+    return it;
+  }
+
+  iterator end() {
+    return iterator(_ctrl + _capacity, _slots + _capacity);
+  }
+
+  const_iterator cbegin() const {
+    return const_cast<FlatUnorderedMap*>(this)->begin();
+  }
+
+  const_iterator cend() const {
+    return const_cast<FlatUnorderedMap*>(this)->end();
+  }
+
+  const_iterator begin() const {
+    return cbegin();
+  }
+
+  const_iterator end() const {
+    return cend();
+  }
+
+private:
+  class _Group {
+   public:
+    static constexpr size_t width = 16;
+
+    explicit _Group(const int8_t* ctrl) {
+#ifdef __SSE2__
+      _ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+      std::copy(ctrl, ctrl + width, _ctrl);
+#endif
+    }
+
+    uint32_t match(int8_t h2) const {
+#ifdef __SSE2__
+      return static_cast<uint32_t>(
+          _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), _ctrl)));
+#else
+      uint32_t mask = 0;
+      for (size_t i = 0; i < width; ++i) {
+        mask |= static_cast<uint32_t>(_ctrl[i] == h2) << i;
+      }
+      return mask;
+#endif
+    }
+
+    uint32_t match_empty() const {
+      return match(_empty);
+    }
+
+    uint32_t match_free() const {
+#ifdef __SSE2__
+      return static_cast<uint32_t>(_mm_movemask_epi8(_ctrl));
+#else
+      uint32_t mask = 0;
+      for (size_t i = 0; i < width; ++i) {
+        mask |= static_cast<uint32_t>(_ctrl[i] < 0) << i;
+      }
+      return mask;
+#endif
+    }
+
+   private:
+#ifdef __SSE2__
+    __m128i _ctrl;
+#else
+    int8_t _ctrl[width];
+#endif
+  };
+
+  static constexpr int8_t _empty = -128;
+  static constexpr int8_t _deleted = -2;
+  static constexpr int8_t _sentinel = -1;
+
+  template <typename... Args>
+  static constexpr bool _is_key_value() {
+    if constexpr (sizeof...(Args) == 2) {
+      return std::is_same_v<std::remove_cvref_t<std::tuple_element_t<0, std::tuple<Args...>>>, Key>;
+    }
+    return false;
+  }
+
+  template <typename... Args>
+  static constexpr bool _is_pair() {
+    if constexpr (sizeof...(Args) == 1) {
+      using P = std::remove_cvref_t<std::tuple_element_t<0, std::tuple<Args...>>>;
+      return std::is_same_v<P, NodeType> || std::is_same_v<P, std::pair<Key, Value>>;
+    }
+    return false;
+  }
+
+  static int8_t* _empty_ctrl();
+  static size_t _mix(size_t hash);
+
+  size_t _find_index(const Key& key, size_t hash) const;
+  size_t _find_free(size_t hash) const;
+  size_t _prepare_insert(size_t hash);
+  void _set_ctrl(size_t index, int8_t value);
+  void _resize(size_t capacity);
+  void _destroy();
+
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> _try_emplace(K&& key, Args&&... args);
+
+  template <typename Arg>
+  Value& _elem_by_index(Arg&& key);
+
+  [[no_unique_address]] Alloc _alloc;
+  [[no_unique_address]] CtrlAlloc _ctrl_alloc;
+  [[no_unique_address]] Hash _hash;
+  [[no_unique_address]] Equal _equal_to;
+
+  int8_t* _ctrl = _empty_ctrl();
+  NodeType* _slots = nullptr;
+  size_t _capacity = 0;
+  size_t _size = 0;
+  size_t _growth_left = 0;
+};
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+int8_t* FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::_empty_ctrl() {
+  static int8_t ctrl[_Group::width] = {_sentinel};
+  return ctrl;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::_mix(size_t hash) {
+  uint64_t value = static_cast<uint64_t>(hash);
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdull;
+  value ^= value >> 33;
+  return static_cast<size_t>(value);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::_find_index(const Key& key,
+                                                                       size_t hash) const {
+  if (_capacity == 0) {
+    return _capacity;
+  }
+
+  int8_t h2 = static_cast<int8_t>(hash & 0x7f);
+  size_t mask = _capacity / _Group::width - 1;
+  size_t group = (hash >> 7) & mask;
+  for (size_t step = 1; ; ++step) {
+    _Group ctrl(_ctrl + group * _Group::width);
+    for (uint32_t match = ctrl.match(h2); match != 0; match &= match - 1) {
+      size_t index = group * _Group::width + static_cast<size_t>(std::countr_zero(match));
+      if (_equal_to(_slots[index].first, key)) {
+        return index;
+      }
+    }
+    if (ctrl.match_empty() != 0) {
+      return _capacity;
+    }
+    group = (group + step) & mask;
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::_find_free(size_t hash) const {
+  size_t mask = _capacity / _Group::width - 1;
+  size_t group = (hash >> 7) & mask;
+  for (size_t step = 1; ; ++step) {
+    uint32_t free = _Group(_ctrl + group * _Group::width).match_free();
+    if (free != 0) {
+      return group * _Group::width + static_cast<size_t>(std::countr_zero(free));
+    }
+    group = (group + step) & mask;
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::_prepare_insert(size_t hash) {
+  if (_growth_left == 0) {
+    if (_size < _capacity * 7 / 16) {
+      _resize(_capacity);
+    } else {
+      _resize(std::max<size_t>(2 * _capacity, _Group::width));
+    }
+  }
+  return _find_free(hash);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::_set_ctrl(size_t index, int8_t value) {
+  if (_ctrl[index] == _empty) {
+    --_growth_left;
+  }
+  _ctrl[index] = value;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::_resize(size_t capacity) {
+  int8_t* old_ctrl = _ctrl;
+  NodeType* old_slots = _slots;
+  size_t old_capacity = _capacity;
+  size_t old_growth_left = _growth_left;
+
+  _ctrl = CtrlAllocTraits::allocate(_ctrl_alloc, capacity + 1);
+  try {
+    _slots = AllocTraits::allocate(_alloc, capacity);
+  } catch (...) {
+    CtrlAllocTraits::deallocate(_ctrl_alloc, _ctrl, capacity + 1);
+    _ctrl = old_ctrl;
+    throw;
+  }
+  std::fill(_ctrl, _ctrl + capacity, _empty);
+  _ctrl[capacity] = _sentinel;
+  _capacity = capacity;
+  _growth_left = capacity * 7 / 8;
+
+  size_t i = 0;
+  try {
+    for (; i < old_capacity; ++i) {
+      if (old_ctrl[i] >= 0) {
+        size_t hash = _mix(_hash(old_slots[i].first));
+        size_t index = _find_free(hash);
+        AllocTraits::construct(_alloc, _slots + index, std::move(old_slots[i]));
+        _set_ctrl(index, static_cast<int8_t>(hash & 0x7f));
+      }
+    }
+  } catch (...) {
+    for (size_t j = 0; j < capacity; ++j) {
+      if (_ctrl[j] >= 0) {
+        AllocTraits::destroy(_alloc, _slots + j);
+      }
+    }
+    AllocTraits::deallocate(_alloc, _slots, capacity);
+    CtrlAllocTraits::deallocate(_ctrl_alloc, _ctrl, capacity + 1);
+    _ctrl = old_ctrl;
+    _slots = old_slots;
+    _capacity = old_capacity;
+    _growth_left = old_growth_left;
+    throw;
+  }
+
+  for (i = 0; i < old_capacity; ++i) {
+    if (old_ctrl[i] >= 0) {
+      AllocTraits::destroy(_alloc, old_slots + i);
+    }
+  }
+  if (old_capacity > 0) {
+    AllocTraits::deallocate(_alloc, old_slots, old_capacity);
+    CtrlAllocTraits::deallocate(_ctrl_alloc, old_ctrl, old_capacity + 1);
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::_destroy() {
+  if (_capacity == 0) {
+    return;
+  }
+
+  for (size_t i = 0; i < _capacity; ++i) {
+    if (_ctrl[i] >= 0) {
+      AllocTraits::destroy(_alloc, _slots + i);
+    }
+  }
+  AllocTraits::deallocate(_alloc, _slots, _capacity);
+  CtrlAllocTraits::deallocate(_ctrl_alloc, _ctrl, _capacity + 1);
+
+  _ctrl = _empty_ctrl();
+  _slots = nullptr;
+  _capacity = 0;
+  _size = 0;
+  _growth_left = 0;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::FlatUnorderedMap(
+  const FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>& other)
+  : _alloc(AllocTraits::select_on_container_copy_construction(other._alloc)),
+  _ctrl_alloc(_alloc), _hash(other._hash), _equal_to(other._equal_to) {
+  if (other._size > 0) {
+    rehash(other._size + other._size / 7);
+    try {
+      insert(other.begin(), other.end());
+    } catch (...) {
+      _destroy();
+      throw;
+    }
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::FlatUnorderedMap(
+  FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>&& other) noexcept
+  : _alloc(std::move(other._alloc)), _ctrl_alloc(std::move(other._ctrl_alloc)),
+  _hash(std::move(other._hash)), _equal_to(std::move(other._equal_to)),
+  _ctrl(std::exchange(other._ctrl, _empty_ctrl())),
+  _slots(std::exchange(other._slots, nullptr)),
+  _capacity(std::exchange(other._capacity, 0)),
+  _size(std::exchange(other._size, 0)),
+  _growth_left(std::exchange(other._growth_left, 0)) {}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::~FlatUnorderedMap() {
+  _destroy();
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>&
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::operator=(
+  const FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>& other) {
+  if (this == &other) {
+    return *this;
+  }
+
+  FlatUnorderedMap<Key, Value, Hash, Equal, Alloc> copy = other;
+  _destroy();
+  if (AllocTraits::propagate_on_container_copy_assignment::value) {
+    _alloc = other._alloc;
+    _ctrl_alloc = other._ctrl_alloc;
+  }
+  *this = std::move(copy);
+  return *this;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>&
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::operator=(
+  FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>&& other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+
+  _destroy();
+  if (AllocTraits::propagate_on_container_move_assignment::value) {
+    _alloc = std::move(other._alloc);
+    _ctrl_alloc = std::move(other._ctrl_alloc);
+  }
+  _hash = std::move(other._hash);
+  _equal_to = std::move(other._equal_to);
+  _ctrl = std::exchange(other._ctrl, _empty_ctrl());
+  _slots = std::exchange(other._slots, nullptr);
+  _capacity = std::exchange(other._capacity, 0);
+  _size = std::exchange(other._size, 0);
+  _growth_left = std::exchange(other._growth_left, 0);
+
+  return *this;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::rehash(size_t bucket_count) {
+  size_t needed = _size + _size / 7;
+  bucket_count = std::max(bucket_count, needed + 1);
+  size_t capacity = std::max(std::bit_ceil(bucket_count), _Group::width);
+  if (capacity != _capacity) {
+    _resize(capacity);
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template <typename K, typename... Args>
+std::pair<typename FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator, bool>
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::_try_emplace(K&& key, Args&&... args) {
+  size_t hash = _mix(_hash(key));
+  size_t index = _find_index(key, hash);
+  if (index != _capacity) {
+    return {iterator(_ctrl + index, _slots + index), false};
+  }
+
+  index = _prepare_insert(hash);
+  AllocTraits::construct(_alloc, _slots + index, std::piecewise_construct,
+                         std::forward_as_tuple(std::forward<K>(key)),
+                         std::forward_as_tuple(std::forward<Args>(args)...));
+  _set_ctrl(index, static_cast<int8_t>(hash & 0x7f));
+  ++_size;
+  return {iterator(_ctrl + index, _slots + index), true};
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template <typename... Args>
+std::pair<typename FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator, bool>
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::emplace(Args&&... args) {
+  if constexpr (_is_key_value<Args...>()) {
+    return _try_emplace(std::forward<Args>(args)...);
+  } else if constexpr (_is_pair<Args...>()) {
+    return _try_emplace(std::forward<Args>(args).first..., std::forward<Args>(args).second...);
+  } else {
+    NodeType node(std::forward<Args>(args)...);
+    return _try_emplace(node.first, std::move(node.second));
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template <typename... Args>
+std::pair<typename FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator, bool>
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::try_emplace(const Key& key, Args&&... args) {
+  return _try_emplace(key, std::forward<Args>(args)...);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template <typename... Args>
+std::pair<typename FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator, bool>
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::try_emplace(Key&& key, Args&&... args) {
+  return _try_emplace(std::move(key), std::forward<Args>(args)...);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+std::pair<typename FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator, bool>
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::insert(const NodeType& elem) {
+  return emplace(elem);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+std::pair<typename FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator, bool>
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::insert(NodeType&& elem) {
+  return emplace(std::move(elem));
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template <typename InputIt>
+void FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::insert(InputIt first, InputIt last) {
+  for (; first != last; ++first) {
+    emplace(*first);
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template <typename Arg>
+Value& FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::_elem_by_index(Arg&& key) {
+  size_t hash = _mix(_hash(key));
+  size_t index = _find_index(key, hash);
+  if (index != _capacity) {
+    return _slots[index].second;
+  }
+
+  if constexpr (std::is_default_constructible<Value>::value) {
+    index = _prepare_insert(hash);
+    AllocTraits::construct(_alloc, _slots + index, std::piecewise_construct,
+                           std::forward_as_tuple(std::forward<Arg>(key)), std::tuple<>());
+    _set_ctrl(index, static_cast<int8_t>(hash & 0x7f));
+    ++_size;
+    return _slots[index].second;
+  }
+
+  throw std::logic_error("type must be default constructible");
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+Value& FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::operator[](const Key& key) {
+  return _elem_by_index(key);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+Value& FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::operator[](Key&& key) {
+  return _elem_by_index(std::move(key));
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+Value& FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::at(const Key& key) {
+  iterator it = find(key);
+  if (it == end()) {
+    throw std::out_of_range("the container does not have an element with the specified key");
+  }
+  return it->second;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+const Value& FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::at(const Key& key) const {
+  const_iterator it = find(key);
+  if (it == end()) {
+    throw std::out_of_range("the container does not have an element with the specified key");
+  }
+  return it->second;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::find(const Key& key) {
+  size_t index = _find_index(key, _mix(_hash(key)));
+  return iterator(_ctrl + index, _slots + index);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::const_iterator
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::find(const Key& key) const {
+  return const_cast<FlatUnorderedMap*>(this)->find(key);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::erase(const_iterator pos) {
+  size_t index = static_cast<size_t>(pos._ctrl - _ctrl);
+  AllocTraits::destroy(_alloc, _slots + index);
+  --_size;
+
+  size_t group = index / _Group::width * _Group::width;
+  if (_Group(_ctrl + group).match_empty() != 0) {
+    _ctrl[index] = _empty;
+    ++_growth_left;
+  } else {
+    _ctrl[index] = _deleted;
+  }
+
+  iterator it(_ctrl + index, _slots + index);
+  it._skip_free();
+  return it;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator
+FlatUnorderedMap<Key, Value, Hash, Equal, Alloc>::erase(const_iterator first,
+                                                        const_iterator last) {
+  iterator it(first._ctrl, first._slot);
+  for (; it != last; ) {
+    it = erase(it);
+  }
+  return it;
+}
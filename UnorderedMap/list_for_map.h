@@ -6,7 +6,8 @@
 #include <type_traits>
 #include <utility>
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
 class UnorderedMap;
 
 template <typename T, typename Allocator = std::allocator<T>>
@@ -294,7 +295,8 @@ class List {
   friend class _iterator<false>;
   friend class _iterator<true>;
   
-  template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+  template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+            typename Policy>
   friend class UnorderedMap;
 
   void _init_fake_node(Node* last_el);
@@ -512,8 +514,11 @@ List<T, Allocator>& List<T, Allocator>::operator=(const List<T, Allocator>& othe
       AllocTraits::deallocate(_node_alloc, static_cast<Node*>(cur._current), 1);
     }
 
-    if (_size != 0) {
+    if (other._size != 0) {
       _init_fake_node(cur);
+    } else {
+      _ptr = static_cast<Node*>(&_fake_node);
+      _fake_node.next = _fake_node.prev = &_fake_node;
     }
     _node_alloc = const_cast<NodeAlloc&>(other._node_alloc);
     _alloc = const_cast<Allocator&>(other._alloc);
@@ -555,8 +560,11 @@ List<T, Allocator>& List<T, Allocator>::operator=(const List<T, Allocator>& othe
       AllocTraits::deallocate(_node_alloc, static_cast<Node*>(cur._current), 1);
     }
 
-    if (_size != 0) {
+    if (other._size != 0) {
       _init_fake_node(cur);
+    } else {
+      _ptr = static_cast<Node*>(&_fake_node);
+      _fake_node.next = _fake_node.prev = &_fake_node;
     }
   }
   _size = other._size;
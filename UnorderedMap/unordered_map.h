@@ -1,15 +1,52 @@
+#include <algorithm>
+#include <bit>
 #include <cmath>
+#include <cstdint>
 #include <stdexcept>
 #include <functional>
 #include <memory>
+#include <span>
 #include <vector>
 #include <type_traits>
 
 #include "list_for_map.h"
 
+struct ModuloBucketPolicy {
+  static size_t mix(size_t hash) {
+    return hash;
+  }
+
+  static size_t bucket_count(size_t count) {
+    return std::max<size_t>(count, 1);
+  }
+
+  static size_t index(size_t hash, size_t bucket_count) {
+    return hash % bucket_count;
+  }
+};
+
+struct PowerOfTwoBucketPolicy {
+  static size_t mix(size_t hash) {
+    uint64_t value = static_cast<uint64_t>(hash);
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    return static_cast<size_t>(value);
+  }
+
+  static size_t bucket_count(size_t count) {
+    return std::bit_ceil(std::max<size_t>(count, 1));
+  }
+
+  static size_t index(size_t hash, size_t bucket_count) {
+    return hash & (bucket_count - 1);
+  }
+};
+
 template <typename Key, typename Value, typename Hash = std::hash<Key>,
           typename Equal = std::equal_to<Key>,
-          typename Alloc = std::allocator<std::pair<const Key, Value>>>
+          typename Alloc = std::allocator<std::pair<const Key, Value>>,
+          typename Policy = ModuloBucketPolicy>
 class UnorderedMap {
 public:
   using NodeType = std::pair<const Key, Value>;
@@ -25,21 +62,67 @@ public:
   using iterator = typename List<NodeType, Alloc>::iterator;
   using const_iterator = typename List<NodeType, Alloc>::const_iterator;
 
+  class NodeHandle {
+  public:
+    NodeHandle() = default;
+
+    NodeHandle(NodeHandle&& other) noexcept = default;
+
+    NodeHandle& operator=(NodeHandle&& other) noexcept = default;
+
+    bool empty() const {
+      return _list.size() == 0;
+    }
+
+    explicit operator bool() const {
+      return !empty();
+    }
+
+    Key& key() const {
+      return const_cast<Key&>(_node()->value_ptr()->first);
+    }
+
+    Value& mapped() const {
+      return _node()->value_ptr()->second;
+    }
+
+    Alloc get_allocator() const {
+      return _list.get_allocator();
+    }
+
+  private:
+    friend class UnorderedMap;
+
+    explicit NodeHandle(const Alloc& alloc) : _list(alloc) {}
+
+    ListNode* _node() const {
+      return static_cast<ListNode*>(_list.cbegin().get_node());
+    }
+
+    List<NodeType, Alloc> _list;
+  };
+
+  struct InsertReturnType {
+    iterator position;
+    bool inserted;
+    NodeHandle node;
+  };
+
   UnorderedMap(const Alloc& alloc = Alloc(), const Hash& hash = Hash(),
                const Equal& equal = Equal())
     : _alloc(alloc), _hash(hash), _equal_to(equal), _list(alloc), _array(1, alloc) {}
 
-  UnorderedMap(const UnorderedMap<Key, Value, Hash, Equal, Alloc>& other);
+  UnorderedMap(const UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>& other);
 
-  UnorderedMap(UnorderedMap<Key, Value, Hash, Equal, Alloc>&& other) noexcept = default;
+  UnorderedMap(UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>&& other) noexcept = default;
 
   ~UnorderedMap() = default;
 
-  UnorderedMap<Key, Value, Hash, Equal, Alloc>&
-    operator=(const UnorderedMap<Key, Value, Hash, Equal, Alloc>& other);
+  UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>&
+    operator=(const UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>& other);
 
-  UnorderedMap<Key, Value, Hash, Equal, Alloc>&
-    operator=(UnorderedMap<Key, Value, Hash, Equal, Alloc>&& other) noexcept;
+  UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>&
+    operator=(UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>&& other) noexcept;
 
   Value& operator[](const Key& key);
 
@@ -53,9 +136,69 @@ public:
 
   const_iterator find(const Key& key) const;
 
+  Value& at(const Key& key, size_t hash);
+
+  const Value& at(const Key& key, size_t hash) const;
+
+  iterator find(const Key& key, size_t hash);
+
+  const_iterator find(const Key& key, size_t hash) const;
+
+  template <typename K> requires _is_transparent
+  Value& operator[](K&& key) {
+    return _elem_by_index(std::forward<K>(key));
+  }
+
+  template <typename K> requires _is_transparent
+  Value& at(const K& key) {
+    return _at(key, _key_hash(key));
+  }
+
+  template <typename K> requires _is_transparent
+  const Value& at(const K& key) const {
+    return _at(key, _key_hash(key));
+  }
+
+  template <typename K> requires _is_transparent
+  iterator find(const K& key) {
+    return _find(key, _key_hash(key));
+  }
+
+  template <typename K> requires _is_transparent
+  const_iterator find(const K& key) const {
+    return _find(key, _key_hash(key));
+  }
+
+  template <typename OutputIt>
+  OutputIt find_batch(std::span<const Key> keys, OutputIt out);
+
+  template <typename OutputIt>
+  OutputIt find_batch(std::span<const Key> keys, OutputIt out) const;
+
+  template <typename OutputIt>
+  OutputIt contains_batch(std::span<const Key> keys, OutputIt out) const;
+
   template <typename... Args>
   std::pair<iterator, bool> emplace(Args&&... args);
 
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args);
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args);
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace_hashed(const Key& key, size_t hash, Args&&... args);
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace_hashed(Key&& key, size_t hash, Args&&... args);
+
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj);
+
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(Key&& key, M&& obj);
+
   std::pair<iterator, bool> insert(const NodeType& elem);
 
   std::pair<iterator, bool> insert(NodeType&& elem);
@@ -66,10 +209,30 @@ public:
   template <typename InputIt>
   void insert(InputIt first, InputIt last);
 
+  InsertReturnType insert(NodeHandle&& handle);
+
+  NodeHandle extract(const_iterator pos);
+
+  NodeHandle extract(const Key& key);
+
+  void merge(UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>& other);
+
+  void merge(UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>&& other);
+
   iterator erase(const_iterator pos);
 
   iterator erase(const_iterator first, const_iterator last);
 
+  size_t erase(const Key& key);
+
+  size_t erase(const Key& key, size_t hash);
+
+  template <typename K>
+    requires _is_transparent && (!std::is_convertible_v<K, const_iterator>)
+  size_t erase(const K& key) {
+    return _erase_key(key, _key_hash(key));
+  }
+
   void rehash(size_t bucket_count);
 
   void reserve(size_t count) {
@@ -92,10 +255,29 @@ public:
     _max_load_factor = mlf;
   }
 
+  bool incremental_rehash() const {
+    return _incremental_rehash;
+  }
+
+  void incremental_rehash(bool enabled) {
+    _incremental_rehash = enabled;
+    if (!enabled) {
+      _migrate(_old_array.size());
+    }
+  }
+
   size_t size() const {
     return _size;
   }
 
+  Hash hash_function() const {
+    return _hash;
+  }
+
+  Equal key_eq() const {
+    return _equal_to;
+  }
+
   iterator begin() {
     return _list.begin();
   }
@@ -121,10 +303,73 @@ public:
   }
 
 private:
+  static constexpr bool _is_transparent =
+      requires { typename Hash::is_transparent; typename Equal::is_transparent; };
+
   template <typename Arg>
   Value& _elem_by_index(Arg&& key);
 
-  iterator _find(const Key& key) const;
+  template <typename K>
+  size_t _key_hash(const K& key) const {
+    return Policy::mix(_hash(key));
+  }
+
+  size_t _bucket_index(size_t hash) const {
+    return Policy::index(hash, _array.size());
+  }
+
+  bool _in_old_array(size_t hash) const {
+    return !_old_array.empty() && Policy::index(hash, _old_array.size()) >= _migrated;
+  }
+
+  ListNode*& _bucket_head(size_t hash) {
+    return _in_old_array(hash) ? _old_array[Policy::index(hash, _old_array.size())]
+                               : _array[_bucket_index(hash)];
+  }
+
+  ListNode* const* _bucket_slot(size_t hash) const {
+    return _in_old_array(hash) ? &_old_array[Policy::index(hash, _old_array.size())]
+                               : &_array[_bucket_index(hash)];
+  }
+
+  ListBaseNode* _old_begin() const {
+    return _old_head != nullptr ? _old_head : _list.cend().get_node();
+  }
+
+  void _link(ListNode* node);
+
+  void _unlink(ListNode* node);
+
+  std::pair<iterator, bool> _insert_pos(const Key& key, size_t hash);
+
+  void _relink(ListNode* node);
+
+  void _migrate(size_t bucket_count);
+
+  void _grow();
+
+  void _copy_buckets(const UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>& other);
+
+  template <typename K>
+  std::pair<iterator, bool> _probe(const K& key, size_t hash) const;
+
+  template <typename F>
+  void _probe_batch(std::span<const Key> keys, F f) const;
+
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> _try_emplace(K&& key, size_t hash, Args&&... args);
+
+  template <typename K, typename M>
+  std::pair<iterator, bool> _insert_or_assign(K&& key, M&& obj);
+
+  template <typename K>
+  iterator _find(const K& key, size_t hash) const;
+
+  template <typename K>
+  Value& _at(const K& key, size_t hash) const;
+
+  template <typename K>
+  size_t _erase_key(const K& key, size_t hash);
 
   [[no_unique_address]] Alloc _alloc;
   [[no_unique_address]] ValueAlloc _val_alloc;
@@ -133,128 +378,329 @@ private:
 
   List<NodeType, Alloc> _list;
   std::vector<ListNode*, ListNodePAlloc> _array;
+  std::vector<ListNode*, ListNodePAlloc> _old_array;
+  ListBaseNode* _old_head = nullptr;
+  size_t _migrated = 0;
   size_t _size = 0;
   float _max_load_factor = 1.0;
+  bool _incremental_rehash = false;
+
+  static const size_t _migrate_step;
+  static constexpr size_t _batch_size = 32;
 };
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-template <typename Arg>
-Value& UnorderedMap<Key, Value, Hash, Equal, Alloc>::_elem_by_index(Arg&& key) {
-  size_t hash = _hash(key);
-  size_t hash_index = hash % _array.size();
-  Value* val;
-
-  if (_array[hash_index] == nullptr) {
-    if constexpr (std::is_default_constructible<Value>::value) {
-      val = ValAllocTraits::allocate(_val_alloc, 1);
-      try {
-        ValAllocTraits::construct(_val_alloc, val); 
-      } catch (...) {
-        ValAllocTraits::deallocate(_val_alloc, val, 1);
-        throw;
-      }
-      
-      Value& ans = emplace(std::forward<Arg>(key),
-        std::move(*val)).first->second;
-      ValAllocTraits::destroy(_val_alloc, val);
-      ValAllocTraits::deallocate(_val_alloc, val, 1);
-      return ans;
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+const size_t UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::_migrate_step = 8;
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::_link(ListNode* node) {
+  ListNode*& head = _bucket_head(node->hash);
+  if (head == nullptr) {
+    head = node;
+    if (_in_old_array(node->hash)) {
+      _old_head = node;
     }
   }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::_unlink(ListNode* node) {
+  ListBaseNode* next = node->next;
+  ListBaseNode* end_node = _list.end().get_node();
+
+  bool in_old_array = _in_old_array(node->hash);
+  size_t bucket_count = in_old_array ? _old_array.size() : _array.size();
+  ListNode*& head = _bucket_head(node->hash);
+  if (head == node) {
+    bool same_bucket = next != (in_old_array ? end_node : _old_begin()) &&
+                       Policy::index(static_cast<ListNode*>(next)->hash, bucket_count) ==
+                       Policy::index(node->hash, bucket_count);
+    head = same_bucket ? static_cast<ListNode*>(next) : nullptr;
+  }
+  if (_old_head == node) {
+    _old_head = next != end_node ? next : nullptr;
+  }
+  --_size;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator, bool>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::_insert_pos(const Key& key,
+                                                                   size_t hash) {
+  _migrate(_migrate_step);
+  if (_size + 1 > _max_load_factor * _array.size()) {
+    _grow();
+  }
+  return _probe(key, hash);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::_relink(ListNode* node) {
+  size_t hash_index = _bucket_index(node->hash);
+  ListBaseNode* pos = _array[hash_index] != nullptr ? _array[hash_index] : _list.begin().get_node();
+  if (pos != node) {
+    _list.splice(const_iterator(pos), _list, const_iterator(node));
+  }
+  _array[hash_index] = node;
+}
 
-  if (_array[hash_index] != nullptr) {
-    for (auto it = iterator(_array[hash_index]); it != end(); ++it) {
-      ListNode* node = static_cast<ListNode*>(it.get_node());
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::_migrate(size_t bucket_count) {
+  if (_old_array.empty()) {
+    return;
+  }
 
-      if (_equal_to(node->value_ptr()->first, key)) {
-        return node->value_ptr()->second;
+  ListBaseNode* end_node = _list.end().get_node();
+  for (; bucket_count > 0 && _migrated < _old_array.size(); --bucket_count, ++_migrated) {
+    ListNode* node = _old_array[_migrated];
+    while (node != nullptr) {
+      ListBaseNode* next = node->next;
+      if (_old_head == node) {
+        _old_head = next != end_node ? next : nullptr;
       }
 
-      if constexpr (std::is_default_constructible<Value>::value) {
-        if (node->hash % _array.size() != hash_index) {
-          val = ValAllocTraits::allocate(_val_alloc, 1);
-          try {
-            ValAllocTraits::construct(_val_alloc, val); 
-          } catch (...) {
-            ValAllocTraits::deallocate(_val_alloc, val, 1);
-            throw;
-          }
-          Value& ans = emplace(std::forward<Arg>(key),
-            std::move(*val)).first->second;
-          ValAllocTraits::destroy(_val_alloc, val);
-          ValAllocTraits::deallocate(_val_alloc, val, 1);
-          return ans;
-        }
+      ListNode* next_node = nullptr;
+      if (next != end_node &&
+          Policy::index(static_cast<ListNode*>(next)->hash, _old_array.size()) == _migrated) {
+        next_node = static_cast<ListNode*>(next);
       }
+
+      _relink(node);
+      node = next_node;
     }
   }
 
-  if constexpr (std::is_default_constructible<Value>::value) {
-    val = ValAllocTraits::allocate(_val_alloc, 1);
-    try {
-      ValAllocTraits::construct(_val_alloc, val); 
-    } catch (...) {
-      ValAllocTraits::deallocate(_val_alloc, val, 1);
-      throw;
+  if (_migrated == _old_array.size()) {
+    _old_array.clear();
+    _old_array.shrink_to_fit();
+    _old_head = nullptr;
+    _migrated = 0;
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::_grow() {
+  if (!_incremental_rehash || _size == 0) {
+    rehash(2 * _array.size());
+    return;
+  }
+
+  _migrate(_old_array.size());
+  std::vector<ListNode*, ListNodePAlloc> new_array(Policy::bucket_count(2 * _array.size()));
+  _old_array = std::move(_array);
+  _array = std::move(new_array);
+  _old_head = _list.begin().get_node();
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::_copy_buckets(
+  const UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>& other) {
+  std::fill(_array.begin(), _array.end(), nullptr);
+  std::fill(_old_array.begin(), _old_array.end(), nullptr);
+  _old_head = nullptr;
+
+  bool in_old_array = false;
+  auto other_it = other._list.cbegin();
+  for (auto it = _list.begin(); it != _list.end(); ++it, ++other_it) {
+    if (other_it.get_node() == other._old_head) {
+      in_old_array = true;
+      _old_head = it.get_node();
+    }
+
+    ListNode* node = static_cast<ListNode*>(it.get_node());
+    ListNode*& head = in_old_array ? _old_array[Policy::index(node->hash, _old_array.size())]
+                                   : _array[_bucket_index(node->hash)];
+    if (head == nullptr) {
+      head = node;
     }
-    Value& ans = emplace(std::forward<Arg>(key),
-      std::move(*val)).first->second;
-    ValAllocTraits::destroy(_val_alloc, val);
-    ValAllocTraits::deallocate(_val_alloc, val, 1);
-    return ans;
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename Arg>
+Value& UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::_elem_by_index(Arg&& key) {
+  if constexpr (std::is_default_constructible<Value>::value) {
+    return _try_emplace(std::forward<Arg>(key), _key_hash(key)).first->second;
+  }
+
+  iterator it = _find(key, _key_hash(key));
+  if (it != end()) {
+    return it->second;
   }
 
   throw std::logic_error("type must be default constructible");
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename K>
+std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator, bool>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::_probe(const K& key, size_t hash) const {
+  bool in_old_array = _in_old_array(hash);
+  size_t bucket_count = in_old_array ? _old_array.size() : _array.size();
+  size_t hash_index = Policy::index(hash, bucket_count);
+  ListNode* head = in_old_array ? _old_array[hash_index] : _array[hash_index];
+  if (head == nullptr) {
+    return {iterator(in_old_array ? _old_begin() : _list.cbegin().get_node()), false};
+  }
+
+  auto it = iterator(head);
+  auto last = iterator(in_old_array ? _list.cend().get_node() : _old_begin());
+  for (; it != last; ++it) {
+    auto node = static_cast<ListNode*>(it.get_node());
 
+    if (node->hash == hash && _equal_to(node->value_ptr()->first, key)) {
+      return {it, true};
+    }
+
+    if (Policy::index(node->hash, bucket_count) != hash_index) {
+      break;
+    }
+  }
+
+  return {it, false};
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator
-UnorderedMap<Key, Value, Hash, Equal, Alloc>::_find(const Key& key) const {
-  size_t hash = _hash(key);
-  size_t hash_index = hash % _array.size();
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename F>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::_probe_batch(std::span<const Key> keys,
+                                                                        F f) const {
+  size_t hashes[_batch_size];
+  for (size_t first = 0; first < keys.size(); first += _batch_size) {
+    size_t count = std::min(_batch_size, keys.size() - first);
+    for (size_t i = 0; i < count; ++i) {
+      hashes[i] = _key_hash(keys[first + i]);
+      __builtin_prefetch(_bucket_slot(hashes[i]));
+    }
 
-  if (_array[hash_index] == nullptr) {
-    return iterator(end().get_node());
-  } else {
-    for (auto it = const_iterator(_array[hash_index]); it != cend(); ++it) {
-      auto node = static_cast<ListNode*>(it.get_node());
+    for (size_t i = 0; i < count; ++i) {
+      __builtin_prefetch(*_bucket_slot(hashes[i]));
+    }
 
-      if (_equal_to(node->value_ptr()->first, key)) {
-        return iterator(it.get_node());
+    for (size_t i = 0; i < count; ++i) {
+      ListNode* head = *_bucket_slot(hashes[i]);
+      if (head != nullptr) {
+        __builtin_prefetch(head->next);
       }
+    }
 
-      if (node->hash % _array.size() != hash_index) {
-        return iterator(end().get_node());
-      }
+    for (size_t i = 0; i < count; ++i) {
+      std::pair<iterator, bool> pos = _probe(keys[first + i], hashes[i]);
+      f(pos.first, pos.second);
     }
   }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename OutputIt>
+OutputIt UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::find_batch(std::span<const Key> keys,
+                                                                          OutputIt out) {
+  _probe_batch(keys, [this, &out](iterator it, bool found) {
+    *out++ = found ? it : end();
+  });
+  return out;
+}
 
-  return iterator(end().get_node());
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename OutputIt>
+OutputIt UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::find_batch(std::span<const Key> keys,
+                                                                          OutputIt out) const {
+  _probe_batch(keys, [this, &out](iterator it, bool found) {
+    *out++ = found ? const_iterator(it) : cend();
+  });
+  return out;
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-UnorderedMap<Key, Value, Hash, Equal, Alloc>::UnorderedMap(
-  const UnorderedMap<Key, Value, Hash, Equal, Alloc>& other)
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename OutputIt>
+OutputIt UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::contains_batch(
+  std::span<const Key> keys, OutputIt out) const {
+  _probe_batch(keys, [&out](iterator, bool found) {
+    *out++ = found;
+  });
+  return out;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename K, typename... Args>
+std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator, bool>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::_try_emplace(K&& key, size_t hash,
+                                                                 Args&&... args) {
+  _migrate(_migrate_step);
+
+  std::pair<iterator, bool> pos = _probe(key, hash);
+  if (pos.second) {
+    return {pos.first, false};
+  }
+
+  if (_size + 1 > _max_load_factor * _array.size()) {
+    _grow();
+    pos = _probe(key, hash);
+  }
+
+  iterator it = _list.emplace(pos.first, hash, std::piecewise_construct,
+                              std::forward_as_tuple(std::forward<K>(key)),
+                              std::forward_as_tuple(std::forward<Args>(args)...));
+  _link(static_cast<ListNode*>(it.get_node()));
+  ++_size;
+  return {it, true};
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename K, typename M>
+std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator, bool>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::_insert_or_assign(K&& key, M&& obj) {
+  std::pair<iterator, bool> ans = _try_emplace(std::forward<K>(key), _key_hash(key),
+                                               std::forward<M>(obj));
+  if (!ans.second) {
+    ans.first->second = std::forward<M>(obj);
+  }
+  return ans;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename K>
+typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::_find(const K& key, size_t hash) const {
+  std::pair<iterator, bool> pos = _probe(key, hash);
+  return pos.second ? pos.first : iterator(end().get_node());
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::UnorderedMap(
+  const UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>& other)
   : _hash(other._hash), _equal_to(other._equal_to), _list(other._list),
-  _array(other._array), _size(other._size), _max_load_factor(other._max_load_factor) {
+  _array(other._array), _old_array(other._old_array), _migrated(other._migrated),
+  _size(other._size), _max_load_factor(other._max_load_factor),
+  _incremental_rehash(other._incremental_rehash) {
 
   _alloc = AllocTraits::select_on_container_copy_construction(other._alloc);
   _val_alloc = AllocTraits::select_on_container_copy_construction(other._val_alloc);
-  size_t prev_hash_index = 0;
-  for (auto it = _list.begin(); it != _list.end(); ++it) {
-    size_t hash_index = static_cast<ListNode*>(it.get_node())->hash % _array.size();
-    if ((it == _list.begin()) || (hash_index != prev_hash_index)) {
-      _array[hash_index] = static_cast<ListNode*>(it.get_node());
-    }
-    prev_hash_index = hash_index;
-  }
+  _copy_buckets(other);
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-UnorderedMap<Key, Value, Hash, Equal, Alloc>&
-UnorderedMap<Key, Value, Hash, Equal, Alloc>::operator=(
-  const UnorderedMap<Key, Value, Hash, Equal, Alloc>& other) {
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>&
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::operator=(
+  const UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>& other) {
   if (AllocTraits::propagate_on_container_copy_assignment::value) {
     _alloc = const_cast<Alloc&>(other._alloc);
   }
@@ -267,24 +713,21 @@ UnorderedMap<Key, Value, Hash, Equal, Alloc>::operator=(
   _equal_to = other._equal_to;
   _list = other._list;
   _array = other._array;
+  _old_array = other._old_array;
+  _migrated = other._migrated;
   _size = other._size;
   _max_load_factor = other._max_load_factor;
-  size_t prev_hash_index = 0;
-  for (auto it = _list.begin(); it != _list.end(); ++it) {
-    size_t hash_index = static_cast<ListNode*>(it.get_node())->hash % _array.size();
-    if ((it == _list.begin()) || (hash_index != prev_hash_index)) {
-      _array[hash_index] = static_cast<ListNode*>(it.get_node());
-    }
-    prev_hash_index = hash_index;
-  }
+  _incremental_rehash = other._incremental_rehash;
+  _copy_buckets(other);
 
   return *this;
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-UnorderedMap<Key, Value, Hash, Equal, Alloc>&
-UnorderedMap<Key, Value, Hash, Equal, Alloc>::operator=(
-  UnorderedMap<Key, Value, Hash, Equal, Alloc>&& other) noexcept {
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>&
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::operator=(
+  UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>&& other) noexcept {
   if (ValAllocTraits::propagate_on_container_move_assignment::value) {
     _val_alloc = std::move(other._val_alloc);
   }
@@ -295,8 +738,15 @@ UnorderedMap<Key, Value, Hash, Equal, Alloc>::operator=(
   _equal_to = std::move(other._equal_to);
   _array = std::move(other._array);
   other._array.resize(1);
+  _old_array = std::move(other._old_array);
+  other._old_array.clear();
+  _old_head = other._old_head;
+  other._old_head = nullptr;
+  _migrated = other._migrated;
+  other._migrated = 0;
   _list = std::move(other._list);
   _max_load_factor = other._max_load_factor;
+  _incremental_rehash = other._incremental_rehash;
   _size = other._size;
   other._size = 0;
   other._max_load_factor = 1.0;
@@ -304,189 +754,293 @@ UnorderedMap<Key, Value, Hash, Equal, Alloc>::operator=(
   return *this;
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-void UnorderedMap<Key, Value, Hash, Equal, Alloc>::rehash(size_t bucket_count) {
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::rehash(size_t bucket_count) {
+  _migrate(_old_array.size());
+
   if (bucket_count < _size / _max_load_factor) {
     bucket_count = static_cast<size_t>(std::ceil(_size / _max_load_factor));
   }
-
-  List<NodeType, Alloc> new_list;
-  std::vector<ListNode*, ListNodePAlloc> new_array(bucket_count);
-
-  for (auto it = _list.begin(); it != _list.end(); ) {
-    auto cur = it++;
-    ListNode* node = static_cast<ListNode*>(cur.get_node());
-    size_t new_hash_index = node->hash % new_array.size();
-
-    if (new_array[new_hash_index] == nullptr) {
-      new_list.splice(new_list.cend(), _list, cur);
-      new_array[new_hash_index] = static_cast<ListNode*>(new_list.end().get_node()->prev);
-    } else {
-      auto iter = typename List<NodeType, Alloc>::iterator(new_array[new_hash_index]);
-      for (; iter != new_list.end(); ++iter) {
-        ListNode* new_node = static_cast<ListNode*>(iter.get_node());
-        if (new_node->hash % new_array.size() != new_hash_index) {
-          new_list.splice(iter, _list, cur);
-          new_array[new_hash_index] = static_cast<ListNode*>(iter.get_node()->prev);
-          break;
-        }
-      }
-      
-      if (iter == new_list.end()) {
-        new_list.splice(new_list.cend(), _list, cur);
-        new_array[new_hash_index] = static_cast<ListNode*>(new_list.end().get_node()->prev);
-      }
-    }
+  bucket_count = Policy::bucket_count(bucket_count);
+  _array.assign(bucket_count, nullptr);
+
+  ListBaseNode* node = _list.begin().get_node();
+  for (size_t i = 0; i < _size; ++i) {
+    ListBaseNode* next = node->next;
+    _relink(static_cast<ListNode*>(node));
+    node = next;
   }
-
-  _array = std::move(new_array);
-  _list = std::move(new_list);
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
 template <typename... Args>
-std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator, bool>
-UnorderedMap<Key, Value, Hash, Equal, Alloc>::emplace(Args&&... args) {
-  if (_size + 1 > _max_load_factor * _array.size()) {
-    rehash(2 * _array.size());
-  }
-
+std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator, bool>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::emplace(Args&&... args) {
   List<NodeType, Alloc> temp_list;
   temp_list.emplace_front(0, std::forward<Args>(args)...);
 
   ListNode* node = static_cast<ListNode*>(temp_list.begin().get_node());
-  size_t hash = _hash(node->value_ptr()->first);
-  node->hash = hash;
-  size_t hash_index = hash % _array.size();
-
-  if (_array[hash_index] == nullptr) {
-    _list.splice(_list.cbegin(), temp_list);
-    std::pair<iterator, bool> ans(_list.begin(), true); 
-    _array[hash_index] = static_cast<ListNode*>(ans.first.get_node());
-    ++_size;
-    return ans;
-  } else {
-    for (auto it = iterator(_array[hash_index]); it != end(); ++it) {
-      auto node = static_cast<ListNode*>(it.get_node());
-
-      if (_equal_to(node->value_ptr()->first,
-          static_cast<ListNode*>(temp_list.begin().get_node())->value_ptr()->first)) {
-        return std::pair<iterator, bool>(it, false);
-      }
+  node->hash = _key_hash(node->value_ptr()->first);
 
-      if (node->hash % _array.size() != hash_index) {
-        _list.splice(it, temp_list);
-        std::pair<iterator, bool> ans(iterator(it.get_node()->prev), true);
-        ++_size;
-        return ans;
-      }
-    }
+  std::pair<iterator, bool> pos = _insert_pos(node->value_ptr()->first, node->hash);
+  if (pos.second) {
+    return {pos.first, false};
   }
 
-  _list.splice(_list.cend(), temp_list);
+  _list.splice(pos.first, temp_list);
+  _link(node);
   ++_size;
-  return std::pair<iterator, bool>(iterator(_list.end().get_node()->prev), true);
+  return {iterator(node), true};
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename... Args>
+std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator, bool>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::try_emplace(const Key& key,
+                                                                 Args&&... args) {
+  return _try_emplace(key, _key_hash(key), std::forward<Args>(args)...);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename... Args>
+std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator, bool>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::try_emplace(Key&& key, Args&&... args) {
+  return _try_emplace(std::move(key), _key_hash(key), std::forward<Args>(args)...);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename... Args>
+std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator, bool>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::try_emplace_hashed(const Key& key, size_t hash,
+                                                                        Args&&... args) {
+  return _try_emplace(key, Policy::mix(hash), std::forward<Args>(args)...);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename... Args>
+std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator, bool>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::try_emplace_hashed(Key&& key, size_t hash,
+                                                                        Args&&... args) {
+  return _try_emplace(std::move(key), Policy::mix(hash), std::forward<Args>(args)...);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename M>
+std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator, bool>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::insert_or_assign(const Key& key, M&& obj) {
+  return _insert_or_assign(key, std::forward<M>(obj));
 }
 
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename M>
+std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator, bool>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::insert_or_assign(Key&& key, M&& obj) {
+  return _insert_or_assign(std::move(key), std::forward<M>(obj));
+}
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator, bool>
-UnorderedMap<Key, Value, Hash, Equal, Alloc>::insert(const NodeType& elem) {
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator, bool>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::insert(const NodeType& elem) {
   return emplace(elem);
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator, bool>
-UnorderedMap<Key, Value, Hash, Equal, Alloc>::insert(NodeType&& elem) {
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator, bool>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::insert(NodeType&& elem) {
   return emplace(std::move(elem));
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
 template <typename Val>
-std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator, bool>
-UnorderedMap<Key, Value, Hash, Equal, Alloc>::insert(Val&& value) {
+std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator, bool>
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::insert(Val&& value) {
   return emplace(std::forward<Val>(value));
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
 template <typename InputIt>
-void UnorderedMap<Key, Value, Hash, Equal, Alloc>::insert(InputIt first, InputIt last) {
+void UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::insert(InputIt first, InputIt last) {
   for (; first != last; ++first) {
     insert(std::forward<decltype(*first)>(*first));
   }
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator
-UnorderedMap<Key, Value, Hash, Equal, Alloc>::find(const Key& key) {
-  return iterator(_find(key));
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::InsertReturnType
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::insert(NodeHandle&& handle) {
+  if (handle.empty()) {
+    return {end(), false, NodeHandle()};
+  }
+
+  ListNode* node = handle._node();
+  node->hash = _key_hash(node->value_ptr()->first);
+  std::pair<iterator, bool> pos = _insert_pos(node->value_ptr()->first, node->hash);
+  if (pos.second) {
+    return {pos.first, false, std::move(handle)};
+  }
+
+  _list.splice(pos.first, handle._list);
+  _link(node);
+  ++_size;
+  return {iterator(node), true, NodeHandle()};
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::NodeHandle
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::extract(const_iterator pos) {
+  NodeHandle handle(_list.get_allocator());
+  _unlink(static_cast<ListNode*>(pos.get_node()));
+  handle._list.splice(handle._list.cend(), _list, pos);
+  return handle;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::NodeHandle
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::extract(const Key& key) {
+  iterator it = _find(key, _key_hash(key));
+  if (it == end()) {
+    return NodeHandle();
+  }
+
+  return extract(it);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::merge(
+  UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>& other) {
+  if (&other == this) {
+    return;
+  }
+
+  for (auto it = other.begin(); it != other.end(); ) {
+    auto cur = it++;
+    ListNode* node = static_cast<ListNode*>(cur.get_node());
+    size_t hash = std::is_empty_v<Hash> ? node->hash : _key_hash(node->value_ptr()->first);
+    std::pair<iterator, bool> pos = _insert_pos(node->value_ptr()->first, hash);
+    if (pos.second) {
+      continue;
+    }
+
+    other._unlink(node);
+    node->hash = hash;
+    _list.splice(pos.first, other._list, cur);
+    _link(node);
+    ++_size;
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::merge(
+  UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>&& other) {
+  merge(other);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::find(const Key& key) {
+  return iterator(_find(key, _key_hash(key)));
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::const_iterator
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::find(const Key& key) const {
+  return _find(key, _key_hash(key));
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::find(const Key& key, size_t hash) {
+  return _find(key, Policy::mix(hash));
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::const_iterator
-UnorderedMap<Key, Value, Hash, Equal, Alloc>::find(const Key& key) const {
-  return _find(key);
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::const_iterator
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::find(const Key& key, size_t hash) const {
+  return _find(key, Policy::mix(hash));
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-Value& UnorderedMap<Key, Value, Hash, Equal, Alloc>::operator[](const Key& key) {
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+Value& UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::operator[](const Key& key) {
   return _elem_by_index(key);
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-Value& UnorderedMap<Key, Value, Hash, Equal, Alloc>::operator[](Key&& key) {
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+Value& UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::operator[](Key&& key) {
   return _elem_by_index(std::move(key));
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-Value& UnorderedMap<Key, Value, Hash, Equal, Alloc>::at(const Key& key) {
-  if (find(key) == end()) {
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename K>
+Value& UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::_at(const K& key, size_t hash) const {
+  iterator it = _find(key, hash);
+  if (it == _list.end()) {
     throw std::out_of_range("the container does not have an element with the specified key");
   }
 
-  return operator[](key);
+  return it->second;
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-const Value& UnorderedMap<Key, Value, Hash, Equal, Alloc>::at(const Key& key) const {
-  if (find(key) == end()) {
-    throw std::out_of_range("the container does not have an element with the specified key");
-  }
-
-  size_t hash = _hash(key);
-  size_t hash_index = hash % _array.size();
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+Value& UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::at(const Key& key) {
+  return _at(key, _key_hash(key));
+}
 
-  for (auto it = iterator(_array[hash_index]); it != end(); ++it) {
-    ListNode* node = static_cast<ListNode*>(it.get_node());
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+const Value& UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::at(const Key& key) const {
+  return _at(key, _key_hash(key));
+}
 
-    if (_equal_to(node->value_ptr()->first, key)) {
-      return node->value_ptr()->second;
-    }
-  }
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+Value& UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::at(const Key& key, size_t hash) {
+  return _at(key, Policy::mix(hash));
+}
 
-  return _array[hash_index]->value_ptr()->second;
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+const Value& UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::at(const Key& key,
+                                                                      size_t hash) const {
+  return _at(key, Policy::mix(hash));
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator
-UnorderedMap<Key, Value, Hash, Equal, Alloc>::erase(const_iterator pos) {
-  size_t hash_index = static_cast<ListNode*>(pos.get_node())->hash % _array.size();
-  --_size;
-  if ((_array[hash_index] == pos.get_node()) &&
-      (pos.get_node()->next == _list.end().get_node() ||
-       static_cast<ListNode*>(pos.get_node()->next)->hash % _array.size() != hash_index)) {
-    _array[hash_index] = nullptr;
-    return _list.erase(pos);
-  } else if (_array[hash_index] == pos.get_node()) {
-    _array[hash_index] = static_cast<ListNode*>(pos.get_node()->next);
-    return _list.erase(pos);
-  }
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::erase(const_iterator pos) {
+  _unlink(static_cast<ListNode*>(pos.get_node()));
   return _list.erase(pos);
 }
 
-template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::iterator
-UnorderedMap<Key, Value, Hash, Equal, Alloc>::erase(const_iterator first, const_iterator last) {
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+typename UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::iterator
+UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::erase(const_iterator first, const_iterator last) {
   if (first == last) {
     return iterator(static_cast<ListNode*>(first.get_node()));
   }
@@ -497,3 +1051,28 @@ UnorderedMap<Key, Value, Hash, Equal, Alloc>::erase(const_iterator first, const_
 
   return iterator(first.get_node());
 }
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+template <typename K>
+size_t UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::_erase_key(const K& key, size_t hash) {
+  iterator it = _find(key, hash);
+  if (it == end()) {
+    return 0;
+  }
+
+  erase(it);
+  return 1;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+size_t UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::erase(const Key& key) {
+  return _erase_key(key, _key_hash(key));
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+          typename Policy>
+size_t UnorderedMap<Key, Value, Hash, Equal, Alloc, Policy>::erase(const Key& key, size_t hash) {
+  return _erase_key(key, Policy::mix(hash));
+}
@@ -0,0 +1,87 @@
+// g++ -std=c++20 -O2 -pthread bench/thread_pool_bench.cpp -o thread_pool_bench
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+
+#include "../thread_pool.h"
+
+static uint64_t fib_serial(int n) {
+  return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+static uint64_t fib_parallel(ThreadPool& pool, int n, int cutoff) {
+  if (n <= cutoff) {
+    return fib_serial(n);
+  }
+
+  uint64_t left = 0;
+  TaskGroup group(pool);
+  group.run([&pool, &left, n, cutoff] {
+    left = fib_parallel(pool, n - 1, cutoff);
+  });
+  uint64_t right = fib_parallel(pool, n - 2, cutoff);
+  group.wait();
+  return left + right;
+}
+
+static uint64_t sum_parallel(ThreadPool& pool, const uint64_t* first, const uint64_t* last,
+                             size_t grain) {
+  size_t count = static_cast<size_t>(last - first);
+  if (count <= grain) {
+    return std::accumulate(first, last, uint64_t{0});
+  }
+
+  const uint64_t* middle = first + count / 2;
+  uint64_t left = 0;
+  TaskGroup group(pool);
+  group.run([&pool, &left, first, middle, grain] {
+    left = sum_parallel(pool, first, middle, grain);
+  });
+  uint64_t right = sum_parallel(pool, middle, last, grain);
+  group.wait();
+  return left + right;
+}
+
+template <typename Func>
+static double measure(Func&& func) {
+  auto start = std::chrono::steady_clock::now();
+  func();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+  int n = argc > 1 ? std::atoi(argv[1]) : 40;
+  int cutoff = argc > 2 ? std::atoi(argv[2]) : 20;
+  size_t threads = argc > 3 ? std::strtoull(argv[3], nullptr, 10)
+                            : std::thread::hardware_concurrency();
+
+  std::vector<uint64_t> values(1 << 26);
+  std::iota(values.begin(), values.end(), uint64_t{0});
+
+  uint64_t expected_fib = 0;
+  uint64_t expected_sum = 0;
+  double fib_time = measure([&] { expected_fib = fib_serial(n); });
+  double sum_time = measure([&] {
+    expected_sum = std::accumulate(values.begin(), values.end(), uint64_t{0});
+  });
+  std::printf("serial        fib(%d) %.3fs   sum %.3fs\n", n, fib_time, sum_time);
+
+  ThreadPool pool(threads);
+  uint64_t fib = 0;
+  uint64_t sum = 0;
+  fib_time = measure([&] { fib = fib_parallel(pool, n, cutoff); });
+  sum_time = measure([&] {
+    sum = sum_parallel(pool, values.data(), values.data() + values.size(), 1 << 16);
+  });
+  std::printf("%2zu threads    fib(%d) %.3fs   sum %.3fs\n", pool.thread_count(), n, fib_time,
+              sum_time);
+
+  if (fib != expected_fib || sum != expected_sum) {
+    std::printf("result mismatch\n");
+    return 1;
+  }
+  return 0;
+}
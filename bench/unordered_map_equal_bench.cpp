@@ -0,0 +1,96 @@
+// g++ -std=c++20 -O2 bench/unordered_map_equal_bench.cpp -o unordered_map_equal_bench
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../UnorderedMap/unordered_map.h"
+
+static size_t equal_calls = 0;
+
+struct CountingEqual {
+  bool operator()(const std::string& lhs, const std::string& rhs) const {
+    ++equal_calls;
+    return lhs == rhs;
+  }
+};
+
+// Collapses every hash to its bucket index, so nodes sharing a bucket also share a
+// stored hash and the pre-check never skips one: each probe pays for Equal on every
+// node it visits, as it did before the pre-check.
+struct BucketHash {
+  size_t operator()(const std::string& key) const {
+    return std::hash<std::string>()(key) % buckets;
+  }
+
+  size_t buckets = 1;
+};
+
+static std::string make_key(size_t key_len, size_t i) {
+  std::string suffix = std::to_string(i);
+  return std::string(key_len - std::min(key_len, suffix.size()), 'k') + suffix;
+}
+
+template <typename Map>
+static void run(const char* name, Map& map, const std::vector<std::string>& keys,
+                const std::vector<std::string>& hits, const std::vector<std::string>& misses,
+                float load) {
+  map.max_load_factor(load);
+  map.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    map.emplace(keys[i], i);
+  }
+
+  for (const std::vector<std::string>* lookups : {&hits, &misses}) {
+    equal_calls = 0;
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& key : *lookups) {
+      found += map.find(key) != map.end();
+    }
+    double ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count();
+
+    bool is_hit = lookups == &hits;
+    if (found != (is_hit ? lookups->size() : 0)) {
+      std::fprintf(stderr, "%s: wrong lookup result\n", name);
+      std::exit(1);
+    }
+    std::printf("%-12s %-6s %8.3f equal calls/lookup %8.1f ns/lookup\n", name,
+                is_hit ? "hit" : "miss", static_cast<double>(equal_calls) / lookups->size(),
+                ns / lookups->size());
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+  size_t key_len = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 256;
+  float load = argc > 3 ? std::strtof(argv[3], nullptr) : 4.0f;
+
+  std::vector<std::string> keys;
+  std::vector<std::string> misses;
+  for (size_t i = 0; i < count; ++i) {
+    keys.push_back(make_key(key_len, 2 * i));
+    misses.push_back(make_key(key_len, 2 * i + 1));
+  }
+  std::vector<std::string> hits = keys;
+  std::mt19937 gen(42);
+  std::shuffle(hits.begin(), hits.end(), gen);
+
+  UnorderedMap<std::string, size_t, std::hash<std::string>, CountingEqual> with_check;
+  run("pre-check", with_check, keys, hits, misses, load);
+
+  UnorderedMap<std::string, size_t, BucketHash, CountingEqual> without_check(
+    {}, BucketHash{with_check.bucket_count()});
+  run("no pre-check", without_check, keys, hits, misses, load);
+
+  if (with_check.bucket_count() != without_check.bucket_count()) {
+    std::fprintf(stderr, "bucket counts differ, the comparison is not like for like\n");
+    return 1;
+  }
+  return 0;
+}
@@ -1,6 +1,16 @@
+#pragma once
+
 #include <string>
-#include <cmath>
+#include <cstddef>
 #include <iterator>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 template <typename T>
 class Deque {
@@ -9,9 +19,9 @@ class Deque {
 
   explicit Deque();
 
-  explicit Deque(int size);
+  explicit Deque(size_t size);
 
-  Deque(int size, const T& value);
+  Deque(size_t size, const T& value);
 
   Deque(const Deque<T>& deque);
 
@@ -27,6 +37,40 @@ class Deque {
 
   void pop_front();
 
+  template <typename OutputIt>
+  OutputIt pop_back_n(size_t count, OutputIt out);
+
+  template <typename OutputIt>
+  OutputIt pop_front_n(size_t count, OutputIt out);
+
+  void reserve_back(size_t count);
+
+  void reserve_front(size_t count);
+
+  void resize(size_t size);
+
+  void resize(size_t size, const T& value);
+
+  void clear(bool release_blocks = true);
+
+  void shrink_to_fit();
+
+  std::vector<std::span<T>> free_back_segments(size_t count)
+    requires std::is_trivially_copyable_v<T>;
+
+  void commit_back(size_t count)
+    requires std::is_trivially_copyable_v<T>;
+
+  template <typename InputIt>
+  void append(InputIt first, InputIt last);
+
+  void append(std::span<const T> values);
+
+  template <typename InputIt>
+  void prepend(InputIt first, InputIt last);
+
+  void prepend(std::span<const T> values);
+
   T& operator[](size_t index);
 
   const T& operator[](size_t index) const;
@@ -35,12 +79,37 @@ class Deque {
 
   const T& at(size_t index) const;
 
+  struct Handle {
+    std::ptrdiff_t block = 0;
+    size_t offset = 0;
+
+    Handle& operator++() {
+      if (++offset == _inner_size) {
+        ++block;
+        offset = 0;
+      }
+      return *this;
+    }
+
+    bool operator==(const Handle& handle) const = default;
+  };
+
+  Handle handle(size_t index) const;
+
+  Handle end_handle() const;
+
+  size_t index(const Handle& handle) const;
+
+  T& operator[](const Handle& handle);
+
+  const T& operator[](const Handle& handle) const;
+
   template <bool is_const = false>
   class _iterator {
    public:
     using value_type = std::conditional_t<is_const, const T, T>;
     using pointer = std::conditional_t<is_const, const T*, T*>;
-    using difference_type = int;
+    using difference_type = std::ptrdiff_t;
     using reference = std::conditional_t<is_const, const T&, T&>;
     using iterator_category = std::random_access_iterator_tag;
 
@@ -49,36 +118,15 @@ class Deque {
     explicit _iterator(size_t index, const Deque<T>* deque)
       : _outer(deque->_outer),
         _index(index) {
-      if ((deque->_first_alloc_index == deque->_last_alloc_index) &&
-          (deque->_inner_first_index + index <= deque->_inner_last_index)) {
-        _outer_index = deque->_first_alloc_index;
-        _inner_index = deque->_inner_first_index + index;
-      } else {
-        if (deque->_inner_first_index + index < _inner_size) {
-          _outer_index = deque->_first_alloc_index;
-          _inner_index = deque->_inner_first_index + index;
-        } else {
-          index -= (_inner_size - deque->_inner_first_index);
-          _outer_index = index / _inner_size + deque->_first_alloc_index + 1;
-          _inner_index = index % _inner_size;
-        }
-      }
-
-      if (_outer_index < deque->_outer_size) {
-        _current = _outer[_outer_index] + _inner_index;
-      }
+      size_t position = deque->_inner_first_index + index;
+      _set_block(deque->_first_alloc_index + position / _inner_size, position % _inner_size);
     }
 
     _iterator<is_const>& operator++() {
-      if (_inner_index + 1 == _inner_size) {
-        _inner_index = 0;
-        ++_outer_index;
-        _current = _outer[_outer_index] + _inner_index;
-      } else {
-        ++_inner_index;
-        ++_current;
-      }
       ++_index;
+      if (++_current == _block_end) {
+        _set_block(_outer_index + 1, 0);
+      }
       return *this;
     }
 
@@ -89,64 +137,38 @@ class Deque {
     }
 
     _iterator<is_const>& operator+=(difference_type n) {
-      if (n < 0) {
-        return *this -= -n;
-      }
-      if (n == 1) {
-        return operator++();
-      }
-      _index += n;
-
-      if (_inner_index + n < _inner_size) {
-        _inner_index += n;
-        if (_current != nullptr) {
-          _current += n;
-        } else {
-          _current = _outer[_outer_index] + _inner_index + n;
-        }
+      _index += static_cast<size_t>(n);
+
+      difference_type offset = static_cast<difference_type>(_inner_index()) + n;
+      difference_type inner_size = static_cast<difference_type>(_inner_size);
+      if (offset >= 0 && offset < inner_size) {
+        _current += n;
       } else {
-        n -= static_cast<difference_type>(_inner_size - _inner_index);
-        size_t add = static_cast<size_t>(n) / _inner_size;
-        _inner_index = static_cast<size_t>(n) % _inner_size;
-        _outer_index += add + 1;
-        _current = _outer[_outer_index] + _inner_index;
+        difference_type blocks = (offset >= 0) ? offset / inner_size
+                                               : -((-offset - 1) / inner_size) - 1;
+        _set_block(_outer_index + static_cast<size_t>(blocks),
+                   static_cast<size_t>(offset - blocks * inner_size));
       }
       return *this;
     }
 
     _iterator<is_const> operator+(difference_type n) const {
-      _iterator<is_const> it;
-      it._index = _index;
-      it._outer_index = _outer_index;
-      it._inner_index = _inner_index;
-      it._outer = _outer;
-      it._current = _current;
-
+      _iterator<is_const> it = *this;
       return it += n;
     }
 
     _iterator<is_const> operator-(difference_type n) const {
-      _iterator<is_const> it;
-      it._index = _index;
-      it._outer_index = _outer_index;
-      it._inner_index = _inner_index;
-      it._outer = _outer;
-      it._current = _current;
-
+      _iterator<is_const> it = *this;
       return it -= n;
     }
 
     _iterator<is_const>& operator--() {
-      if (_inner_index >= 1) {
-        --_inner_index;
-        --_current;
+      --_index;
+      if (_current == _block_end - _inner_size) {
+        _set_block(_outer_index - 1, _inner_size - 1);
       } else {
-        _inner_index = _inner_size - 1;
-        --_outer_index;
-        _current = _outer[_outer_index] + _inner_index;
+        --_current;
       }
-      --_index;
-      _is_end = false;
       return *this;
     }
 
@@ -157,41 +179,16 @@ class Deque {
     }
 
     _iterator<is_const>& operator-=(difference_type n) {
-      if (n < 0) {
-        return *this += -n;
-      }
-
-      if (n == 1) {
-        return operator--();
-      }
-
-      _index -= n;
-      if (static_cast<size_t>(n) <= _inner_index) {
-        _inner_index -= static_cast<size_t>(n);
-        if (_current != nullptr) {
-          _current -= n;
-        } else {
-          _current = _outer[_outer_index] + _inner_index - n;
-        }
-      } else {
-        n -= static_cast<difference_type>(_inner_index);
-        size_t add = static_cast<size_t>(n) / _inner_size;
-        _inner_index = _inner_size - (static_cast<size_t>(n) % _inner_size);
-        _outer_index -= (add + 1ul);
-        _outer_index += _inner_index / _inner_size;
-        _inner_index %= _inner_size;
-        _current = _outer[_outer_index] + _inner_index;
-      }
-      return *this;
+      return *this += -n;
     }
 
     operator _iterator<true>() {
       _iterator<true> it;
-      it._current = _current;
-      it._inner_index = _inner_index;
+      it._outer = _outer;
       it._outer_index = _outer_index;
       it._index = _index;
-      it._outer = _outer;
+      it._current = _current;
+      it._block_end = _block_end;
 
       return it;
     }
@@ -205,78 +202,74 @@ class Deque {
     }
 
     difference_type operator-(const _iterator<true>& it) const {
-      return static_cast<difference_type>(static_cast<long>(_index) -
-        static_cast<long>(it._index));
+      return static_cast<difference_type>(_index) - static_cast<difference_type>(it._index);
     }
 
     bool operator<(const _iterator<true>& it) const {
-      if (_outer_index != it._outer_index) {
-        return _outer_index < it._outer_index;
-      }
-      return _inner_index < it._inner_index;
+      return _index < it._index;
     }
 
     bool operator>(const _iterator<true>& it) const {
-      if (_outer_index != it._outer_index) {
-        return _outer_index > it._outer_index;
-      }
-      return _inner_index > it._inner_index;
+      return _index > it._index;
     }
 
     bool operator==(const _iterator<true>& it) const {
-      return !(operator<(it) || operator>(it));
+      return _current == it._current;
     }
 
     bool operator!=(const _iterator<true>& it) const {
-      return !operator==(it);
+      return _current != it._current;
     }
 
     bool operator<=(const _iterator<true>& it) const {
-      return operator<(it) || operator==(it);
+      return _index <= it._index;
     }
 
     bool operator>=(const _iterator<true>& it) const {
-      return operator>(it) || operator==(it);
+      return _index >= it._index;
     }
 
     bool operator<(const _iterator<false>& it) const {
-      if (_outer_index != it._outer_index) {
-        return _outer_index < it._outer_index;
-      }
-      return _inner_index < it._inner_index;
+      return _index < it._index;
     }
 
     bool operator>(const _iterator<false>& it) const {
-      if (_outer_index != it._outer_index) {
-        return _outer_index > it._outer_index;
-      }
-      return _inner_index > it._inner_index;
+      return _index > it._index;
     }
 
     bool operator==(const _iterator<false>& it) const {
-      return !(operator<(it) || operator>(it));
+      return _current == it._current;
     }
 
     bool operator!=(const _iterator<false>& it) const {
-      return !operator==(it);
+      return _current != it._current;
     }
 
     bool operator<=(const _iterator<false>& it) const {
-      return operator<(it) || operator==(it);
+      return _index <= it._index;
     }
 
     bool operator>=(const _iterator<false>& it) const {
-      return operator>(it) || operator==(it);
+      return _index >= it._index;
     }
    private:
     friend class Deque<T>;
 
-    bool _is_end{false};
+    void _set_block(size_t outer_index, size_t inner_index) {
+      _outer_index = outer_index;
+      _current = _outer[outer_index] + inner_index;
+      _block_end = _outer[outer_index] + _inner_size;
+    }
+
+    size_t _inner_index() const {
+      return _inner_size - static_cast<size_t>(_block_end - _current);
+    }
+
     T** _outer;
-    size_t _inner_index;
     size_t _outer_index;
     size_t _index;
     pointer _current{nullptr};
+    pointer _block_end{nullptr};
   };
 
   using const_iterator = _iterator<true>;
@@ -338,13 +331,117 @@ class Deque {
     return crend();
   }
 
+  template <typename Func>
+  void for_each_segment(Func func) {
+    _for_each_segment(begin(), end(), [&func](std::span<T> segment) {
+      func(segment);
+      return true;
+    });
+  }
+
+  template <typename Func>
+  void for_each_segment(Func func) const {
+    _for_each_segment(cbegin(), cend(), [&func](std::span<const T> segment) {
+      func(segment);
+      return true;
+    });
+  }
+
+  std::vector<std::span<T>> segments() {
+    std::vector<std::span<T>> ans;
+    for_each_segment([&ans](std::span<T> segment) { ans.push_back(segment); });
+    return ans;
+  }
+
+  std::vector<std::span<const T>> segments() const {
+    std::vector<std::span<const T>> ans;
+    for_each_segment([&ans](std::span<const T> segment) { ans.push_back(segment); });
+    return ans;
+  }
+
+  template <bool is_const, typename Func>
+  friend Func for_each(_iterator<is_const> first, _iterator<is_const> last, Func func) {
+    _for_each_segment(first, last, [&func](auto segment) {
+      for (auto& value : segment) {
+        func(value);
+      }
+      return true;
+    });
+    return func;
+  }
+
+  template <bool is_const, typename OutputIt>
+  friend OutputIt copy(_iterator<is_const> first, _iterator<is_const> last, OutputIt out) {
+    _for_each_segment(first, last, [&out](auto segment) {
+      out = std::copy(segment.begin(), segment.end(), out);
+      return true;
+    });
+    return out;
+  }
+
+  template <typename U>
+  friend void fill(_iterator<false> first, _iterator<false> last, const U& value) {
+    _for_each_segment(first, last, [&value](std::span<T> segment) {
+      std::fill(segment.begin(), segment.end(), value);
+      return true;
+    });
+  }
+
+  template <bool is_const, typename U>
+  friend _iterator<is_const> find(_iterator<is_const> first, _iterator<is_const> last,
+                                  const U& value) {
+    size_t offset = 0;
+    bool found = false;
+    _for_each_segment(first, last, [&](auto segment) {
+      auto it = std::find(segment.begin(), segment.end(), value);
+      offset += static_cast<size_t>(it - segment.begin());
+      found = (it != segment.end());
+      return !found;
+    });
+    return found ? first + static_cast<typename _iterator<is_const>::difference_type>(offset)
+                 : last;
+  }
+
+  template <bool is_const, typename Init>
+  friend Init accumulate(_iterator<is_const> first, _iterator<is_const> last, Init init) {
+    _for_each_segment(first, last, [&init](auto segment) {
+      init = std::accumulate(segment.begin(), segment.end(), std::move(init));
+      return true;
+    });
+    return init;
+  }
+
+  template <bool is_const, typename Init, typename BinaryOp>
+  friend Init accumulate(_iterator<is_const> first, _iterator<is_const> last, Init init,
+                         BinaryOp op) {
+    _for_each_segment(first, last, [&init, &op](auto segment) {
+      init = std::accumulate(segment.begin(), segment.end(), std::move(init), op);
+      return true;
+    });
+    return init;
+  }
+
  private:
   friend class _iterator<false>;
   friend class _iterator<true>;
 
   void _swap(Deque<T>& deque);
-  void _define_size(int size);
+  void _define_size(size_t size);
   void _clear_mem(size_t i, size_t j);
+  void _reserve_outer(size_t count, bool at_front);
+  void _alloc_blocks(size_t from, size_t count);
+  void _free_blocks(size_t from, size_t count);
+  void _commit_back(size_t count);
+  void _ensure_back_blocks(size_t count);
+  void _ensure_front_blocks(size_t count);
+  void _fill_trivially(const T& value);
+
+  template <typename ForwardIt>
+  void _copy_to_blocks(size_t outer_index, size_t inner_index, ForwardIt first, size_t count);
+
+  template <bool is_const, typename Func>
+  static void _for_each_segment(const _iterator<is_const>& first,
+                                const _iterator<is_const>& last, Func func);
 
   static const size_t _inner_size;
 
@@ -358,6 +455,11 @@ class Deque {
 
   size_t _inner_first_index = 0;
   size_t _inner_last_index = 0;
+
+  size_t _spare_front = 0;
+  size_t _spare_back = 0;
+
+  std::ptrdiff_t _first_block_id = 0;
 };
 
 template <typename T>
@@ -373,11 +475,14 @@ void Deque<T>::_swap(Deque<T>& deque) {
   std::swap(_last_alloc_index, deque._last_alloc_index);
   std::swap(_inner_first_index, deque._inner_first_index);
   std::swap(_inner_last_index, deque._inner_last_index);
+  std::swap(_spare_front, deque._spare_front);
+  std::swap(_spare_back, deque._spare_back);
+  std::swap(_first_block_id, deque._first_block_id);
 }
 
 template <typename T>
-void Deque<T>::_define_size(int size) {
-  _alloc_count = static_cast<size_t>(std::ceil(static_cast<double>(size) / _inner_size));
+void Deque<T>::_define_size(size_t size) {
+  _alloc_count = std::max<size_t>((size + _inner_size - 1) / _inner_size, 1);
   _outer_size = 3 * _alloc_count;
   _outer = reinterpret_cast<T**>(new char[sizeof(T*) * _outer_size]);
   _size = size;
@@ -387,6 +492,15 @@ void Deque<T>::_define_size(int size) {
   _inner_first_index = 0;
 
   _inner_last_index = 0;
+
+  if (size == 0) {
+    try {
+      _alloc_blocks(_first_alloc_index, 1);
+    } catch (...) {
+      delete[] reinterpret_cast<char**>(_outer);
+      throw;
+    }
+  }
 }
 
 template <typename T>
@@ -412,8 +526,177 @@ void Deque<T>::_clear_mem(size_t i, size_t j) {
   _last_alloc_index = 0;
 }
 
+template <typename T>
+void Deque<T>::_reserve_outer(size_t count, bool at_front) {
+  size_t used_count = _spare_front + _alloc_count + _spare_back;
+  size_t used_first = _first_alloc_index - _spare_front;
+  size_t new_used_count = used_count + count;
+  size_t new_used_first;
+
+  if (2 * new_used_count < _outer_size) {
+    new_used_first = (_outer_size - new_used_count) / 2 + (at_front ? count : 0);
+    if (new_used_first < used_first) {
+      std::copy(_outer + used_first, _outer + used_first + used_count,
+                _outer + new_used_first);
+    } else {
+      std::copy_backward(_outer + used_first, _outer + used_first + used_count,
+                         _outer + new_used_first + used_count);
+    }
+  } else {
+    size_t new_outer_size = _outer_size + std::max(used_count, count) + count;
+    T** new_outer = reinterpret_cast<T**>(new char[sizeof(T*) * new_outer_size]);
+    new_used_first = (new_outer_size - new_used_count) / 2 + (at_front ? count : 0);
+    std::copy(_outer + used_first, _outer + used_first + used_count,
+              new_outer + new_used_first);
+
+    delete[] reinterpret_cast<char**>(_outer);
+    _outer = new_outer;
+    _outer_size = new_outer_size;
+  }
+
+  _first_alloc_index = new_used_first + _spare_front;
+  _last_alloc_index = _first_alloc_index + _alloc_count - 1;
+}
+
+template <typename T>
+void Deque<T>::_alloc_blocks(size_t from, size_t count) {
+  size_t i = 0;
+  try {
+    for (; i < count; ++i) {
+      _outer[from + i] = reinterpret_cast<T*>(new char[sizeof(T) * _inner_size]);
+    }
+  } catch (...) {
+    _free_blocks(from, i);
+    throw;
+  }
+}
+
+template <typename T>
+void Deque<T>::_free_blocks(size_t from, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    delete[] reinterpret_cast<char*>(_outer[from + i]);
+  }
+}
+
+template <typename T>
+void Deque<T>::_ensure_back_blocks(size_t count) {
+  if (_spare_back >= count) {
+    return;
+  }
+
+  size_t missing = count - _spare_back;
+  if (_last_alloc_index + _spare_back + missing >= _outer_size) {
+    _reserve_outer(missing, false);
+  }
+  _alloc_blocks(_last_alloc_index + _spare_back + 1, missing);
+  _spare_back += missing;
+}
+
+template <typename T>
+void Deque<T>::_ensure_front_blocks(size_t count) {
+  if (_spare_front >= count) {
+    return;
+  }
+
+  size_t missing = count - _spare_front;
+  if (_first_alloc_index < _spare_front + missing) {
+    _reserve_outer(missing, true);
+  }
+  _alloc_blocks(_first_alloc_index - _spare_front - missing, missing);
+  _spare_front += missing;
+}
+
+template <typename T>
+void Deque<T>::_fill_trivially(const T& value) {
+  if (_size == 0) {
+    return;
+  }
+
+  _spare_back = (_size % _inner_size == 0) ? 1 : 0;
+  try {
+    _alloc_blocks(_first_alloc_index, _alloc_count + _spare_back);
+  } catch (...) {
+    delete[] reinterpret_cast<char**>(_outer);
+    throw;
+  }
+
+  std::fill_n(_outer[_first_alloc_index], std::min(_size, _inner_size), value);
+  for (size_t i = 1; i < _alloc_count; ++i) {
+    std::memcpy(_outer[_first_alloc_index + i], _outer[_first_alloc_index],
+                sizeof(T) * std::min(_size - i * _inner_size, _inner_size));
+  }
+
+  _last_alloc_index = _first_alloc_index + _alloc_count - 1;
+  _inner_last_index = (_size - 1) % _inner_size;
+}
+
+template <typename T>
+template <typename ForwardIt>
+void Deque<T>::_copy_to_blocks(size_t outer_index, size_t inner_index, ForwardIt first,
+                               size_t count) {
+  size_t i = outer_index;
+  size_t j = inner_index;
+  size_t done = 0;
+  try {
+    while (done < count) {
+      size_t chunk = std::min(count - done, _inner_size - j);
+      if constexpr (std::is_trivially_copyable_v<T> && std::contiguous_iterator<ForwardIt> &&
+                    std::is_same_v<std::iter_value_t<ForwardIt>, T>) {
+        std::memcpy(_outer[i] + j, std::to_address(first), sizeof(T) * chunk);
+        first += chunk;
+        done += chunk;
+      } else {
+        for (size_t k = 0; k < chunk; ++k, ++first, ++done) {
+          new (_outer[i] + j + k) T(*first);
+        }
+      }
+      ++i;
+      j = 0;
+    }
+  } catch (...) {
+    for (i = outer_index, j = inner_index; done > 0; --done) {
+      (_outer[i] + j)->~T();
+      if (++j == _inner_size) {
+        ++i;
+        j = 0;
+      }
+    }
+    throw;
+  }
+}
+
+template <typename T>
+template <bool is_const, typename Func>
+void Deque<T>::_for_each_segment(const _iterator<is_const>& first,
+                                 const _iterator<is_const>& last, Func func) {
+  using segment_type = std::span<typename _iterator<is_const>::value_type>;
+
+  if (first._outer_index == last._outer_index) {
+    if (first._current != last._current) {
+      func(segment_type(first._current, last._current));
+    }
+    return;
+  }
+
+  if (!func(segment_type(first._current, first._block_end))) {
+    return;
+  }
+  for (size_t i = first._outer_index + 1; i < last._outer_index; ++i) {
+    if (!func(segment_type(first._outer[i], _inner_size))) {
+      return;
+    }
+  }
+
+  if (last._inner_index() > 0) {
+    func(segment_type(first._outer[last._outer_index], last._inner_index()));
+  }
+}
+
 template <typename T>
 Deque<T>::~Deque() noexcept {
+  _free_blocks(_first_alloc_index - _spare_front, _spare_front);
+  _free_blocks(_last_alloc_index + 1, _spare_back);
+
   for (size_t i = _last_alloc_index + 1; (i--) > _first_alloc_index + 1;) {
     for (size_t j = 0; j <= _inner_last_index; ++j) {
       (_outer[i] + j)->~T();
@@ -453,9 +736,14 @@ Deque<T>::Deque(): _outer(reinterpret_cast<T**>(new char[sizeof(T*) * 5])),
 }
 
 template <typename T>
-Deque<T>::Deque(int size) {
+Deque<T>::Deque(size_t size) {
   _define_size(size);
 
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    _fill_trivially(T());
+    return;
+  }
+
   size_t i = _alloc_count;
   size_t j = 0;
   for (; (size > 0) && (i < _outer_size); ++i) {
@@ -473,12 +761,26 @@ Deque<T>::Deque(int size) {
       --size;
     }
   }
+
+  if (_size > 0 && _inner_last_index + 1 == _inner_size) {
+    try {
+      _ensure_back_blocks(1);
+    } catch (...) {
+      _clear_mem(_last_alloc_index, _inner_size);
+      throw;
+    }
+  }
 }
 
 template <typename T>
-Deque<T>::Deque(int size, const T& value) {
+Deque<T>::Deque(size_t size, const T& value) {
   _define_size(size);
 
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    _fill_trivially(value);
+    return;
+  }
+
   size_t i = _alloc_count;
   size_t j = 0;
   try {
@@ -496,6 +798,15 @@ Deque<T>::Deque(int size, const T& value) {
     _clear_mem(i, j);  
     throw;
   }
+
+  if (_size > 0 && _inner_last_index + 1 == _inner_size) {
+    try {
+      _ensure_back_blocks(1);
+    } catch (...) {
+      _clear_mem(_last_alloc_index, _inner_size);
+      throw;
+    }
+  }
 }
 
 template <typename T>
@@ -503,36 +814,61 @@ Deque<T>::Deque(const Deque<T>& deque): _first_alloc_index(deque._first_alloc_in
   _outer = reinterpret_cast<T**>(new char[sizeof(T*) * deque._outer_size]);
   size_t i = deque._first_alloc_index;
   size_t j = 0;
-  try {
-    _outer[i] = reinterpret_cast<T*>(new char[sizeof(T) * _inner_size]);
-    size_t constraint = _inner_size;
-    bool is_one_alloced = deque._first_alloc_index == deque._last_alloc_index;
-    if (is_one_alloced) {
-      constraint = deque._inner_last_index;
-    }
-    for (j = deque._inner_first_index; j <= constraint; ++j) {
-      if (j != _inner_size) {
-        new (_outer[i] + j) T(deque._outer[i][j]);
-      }
+  size_t end_block =
+      (deque._size > 0 && deque._inner_last_index + 1 == _inner_size) ? 1 : 0;
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    try {
+      _alloc_blocks(deque._first_alloc_index, deque._alloc_count + end_block);
+    } catch (...) {
+      delete[] reinterpret_cast<char**>(_outer);
+      throw;
     }
-    ++i;
-    for (; i < deque._last_alloc_index; ++i) {
-      j = 0;
-      _outer[i] = reinterpret_cast<T*>(new char[sizeof(T) * _inner_size]);
-      for (; j < _inner_size; ++j) {
-        new (_outer[i] + j) T(deque._outer[i][j]);
-      }
+
+    for (; (deque._size > 0) && (i <= deque._last_alloc_index); ++i) {
+      size_t from = (i == deque._first_alloc_index) ? deque._inner_first_index : 0;
+      size_t to = (i == deque._last_alloc_index) ? deque._inner_last_index + 1 : _inner_size;
+      std::memcpy(_outer[i] + from, deque._outer[i] + from, sizeof(T) * (to - from));
+    }
+  } else {
+    try {
+      _alloc_blocks(deque._last_alloc_index + 1, end_block);
+    } catch (...) {
+      delete[] reinterpret_cast<char**>(_outer);
+      throw;
     }
 
-    if (!is_one_alloced) {
+    try {
       _outer[i] = reinterpret_cast<T*>(new char[sizeof(T) * _inner_size]);
-      for (j = 0; j <= deque._inner_last_index; ++j) {
-        new (_outer[i] + j) T(deque._outer[i][j]);
+      size_t constraint = _inner_size;
+      bool is_one_alloced = deque._first_alloc_index == deque._last_alloc_index;
+      if (is_one_alloced) {
+        constraint = deque._inner_last_index;
+      }
+      for (j = deque._inner_first_index; (deque._size > 0) && (j <= constraint); ++j) {
+        if (j != _inner_size) {
+          new (_outer[i] + j) T(deque._outer[i][j]);
+        }
+      }
+      ++i;
+      for (; i < deque._last_alloc_index; ++i) {
+        j = 0;
+        _outer[i] = reinterpret_cast<T*>(new char[sizeof(T) * _inner_size]);
+        for (; j < _inner_size; ++j) {
+          new (_outer[i] + j) T(deque._outer[i][j]);
+        }
       }
+
+      if (!is_one_alloced) {
+        _outer[i] = reinterpret_cast<T*>(new char[sizeof(T) * _inner_size]);
+        for (j = 0; j <= deque._inner_last_index; ++j) {
+          new (_outer[i] + j) T(deque._outer[i][j]);
+        }
+      }
+    } catch (...) {
+      _free_blocks(deque._last_alloc_index + 1, end_block);
+      _clear_mem(i, j);
+      throw;
     }
-  } catch (...) {
-    _clear_mem(i, j);
-    throw;
   }
 
   _outer_size = deque._outer_size;
@@ -546,6 +882,9 @@ Deque<T>::Deque(const Deque<T>& deque): _first_alloc_index(deque._first_alloc_in
   _inner_first_index = deque._inner_first_index;
   _inner_last_index = deque._inner_last_index;
 
+  _spare_back = end_block;
+  _first_block_id = deque._first_block_id;
+
 }
 
 template <typename T>
@@ -570,45 +909,16 @@ void Deque<T>::push_back(const T& value) {
     _inner_first_index = 0;
     _inner_last_index = 0;
   } else if (_inner_last_index + 1 < _inner_size) {
+    if (_inner_last_index + 2 == _inner_size) {
+      _ensure_back_blocks(1);
+    }
     new (_outer[_last_alloc_index] + _inner_last_index + 1) T(value);
     ++_inner_last_index;
-  } else if (_last_alloc_index + 1 < _outer_size) {
-    _outer[_last_alloc_index + 1] = reinterpret_cast<T*>(new char[sizeof(T) * _inner_size]);
-    try {
-      new (_outer[_last_alloc_index + 1]) T(value);
-    } catch (...) {
-      delete[] reinterpret_cast<char*>(_outer[_last_alloc_index + 1]);
-      throw;
-    }
-    ++_last_alloc_index;
-    _inner_last_index = 0;
-    ++_alloc_count;
   } else {
-    T** new_outer = reinterpret_cast<T**>(new char[sizeof(T*) * (_outer_size + _alloc_count)]);
-    for (size_t i = _first_alloc_index; i <= _last_alloc_index; ++i) {
-      new_outer[i] = _outer[i];
-    }
-
-    try {
-      new_outer[_last_alloc_index + 1] = reinterpret_cast<T*>(new char[sizeof(T) * _inner_size]);
-    } catch (...) {
-      delete[] reinterpret_cast<char**>(new_outer);
-      throw;
-    }
-
-    try {
-      new (new_outer[_last_alloc_index + 1]) T(value);
-    } catch (...) {
-      delete[] reinterpret_cast<char*>(new_outer[_last_alloc_index + 1]);
-      delete[] reinterpret_cast<char**>(new_outer);
-      throw;
-    }
-
-    delete[] reinterpret_cast<char**>(_outer);
-    _outer = new_outer;
+    new (_outer[_last_alloc_index + 1]) T(value);
     ++_last_alloc_index;
+    --_spare_back;
     _inner_last_index = 0;
-    _outer_size += _alloc_count;
     ++_alloc_count;
   }
 
@@ -624,49 +934,225 @@ void Deque<T>::push_front(const T& value) {
   } else if (_inner_first_index > 0) {
     new (_outer[_first_alloc_index] + _inner_first_index - 1) T(value);
     --_inner_first_index;
-  } else if (_first_alloc_index > 0) {
-    _outer[_first_alloc_index - 1] = reinterpret_cast<T*>(new char[sizeof(T) * _inner_size]);
-    try {
-      new (_outer[_first_alloc_index - 1] + _inner_size - 1) T(value);
-    } catch (...) {
-      delete[] reinterpret_cast<char*>(_outer[_first_alloc_index - 1]);
-      throw;
-    }
+  } else {
+    _ensure_front_blocks(1);
+    new (_outer[_first_alloc_index - 1] + _inner_size - 1) T(value);
     --_first_alloc_index;
+    --_spare_front;
+    --_first_block_id;
     _inner_first_index = _inner_size - 1;
     ++_alloc_count;
+  }
+
+  ++_size;
+}
+
+template <typename T>
+void Deque<T>::reserve_back(size_t count) {
+  size_t free_count = (_size == 0) ? _inner_size : _inner_size - 1 - _inner_last_index;
+  if (count >= free_count) {
+    _ensure_back_blocks((count - free_count + _inner_size) / _inner_size);
+  }
+}
+
+template <typename T>
+void Deque<T>::reserve_front(size_t count) {
+  size_t free_count = (_size == 0) ? 1 : _inner_first_index;
+  if (count > free_count) {
+    _ensure_front_blocks((count - free_count + _inner_size - 1) / _inner_size);
+  }
+}
+
+template <typename T>
+void Deque<T>::resize(size_t size) {
+  resize(size, T());
+}
+
+template <typename T>
+void Deque<T>::resize(size_t size, const T& value) {
+  if (size < _size) {
+    while (_size > size) {
+      pop_back();
+    }
+    return;
+  }
+
+  reserve_back(size - _size);
+  while (_size < size) {
+    push_back(value);
+  }
+}
+
+template <typename T>
+void Deque<T>::clear(bool release_blocks) {
+  for_each_segment([](std::span<T> segment) {
+    std::destroy(segment.begin(), segment.end());
+  });
+
+  if (release_blocks) {
+    _free_blocks(_first_alloc_index - _spare_front, _spare_front);
+    _free_blocks(_first_alloc_index + 1, _alloc_count - 1 + _spare_back);
+    _spare_front = 0;
+    _spare_back = 0;
   } else {
-    T** new_outer;
-    new_outer = reinterpret_cast<T**>(new char[sizeof(T*) * (_outer_size + _alloc_count)]);
-    for (size_t i = _first_alloc_index; i <= _last_alloc_index; ++i) {
-      new_outer[i + _alloc_count] = _outer[i];
+    _spare_back += _alloc_count - 1;
+  }
+
+  _last_alloc_index = _first_alloc_index;
+  _alloc_count = 1;
+  _size = 0;
+  _inner_first_index = 0;
+  _inner_last_index = 0;
+}
+
+template <typename T>
+void Deque<T>::shrink_to_fit() {
+  size_t end_block = (_size > 0 && _inner_last_index + 1 == _inner_size) ? 1 : 0;
+  _free_blocks(_first_alloc_index - _spare_front, _spare_front);
+  _free_blocks(_last_alloc_index + 1 + end_block, _spare_back - end_block);
+  _spare_front = 0;
+  _spare_back = end_block;
+
+  if (_outer_size == _alloc_count + end_block) {
+    return;
+  }
+
+  T** new_outer = reinterpret_cast<T**>(new char[sizeof(T*) * (_alloc_count + end_block)]);
+  std::copy(_outer + _first_alloc_index, _outer + _last_alloc_index + 1 + end_block, new_outer);
+  delete[] reinterpret_cast<char**>(_outer);
+
+  _outer = new_outer;
+  _outer_size = _alloc_count + end_block;
+  _first_alloc_index = 0;
+  _last_alloc_index = _alloc_count - 1;
+}
+
+template <typename T>
+std::vector<std::span<T>> Deque<T>::free_back_segments(size_t count)
+  requires std::is_trivially_copyable_v<T> {
+  reserve_back(count);
+
+  std::vector<std::span<T>> ans;
+  size_t outer_index = _last_alloc_index;
+  size_t inner_index = (_size == 0) ? 0 : _inner_last_index + 1;
+  while (count > 0) {
+    if (inner_index == _inner_size) {
+      ++outer_index;
+      inner_index = 0;
     }
+    size_t chunk = std::min(count, _inner_size - inner_index);
+    ans.emplace_back(_outer[outer_index] + inner_index, chunk);
+    inner_index += chunk;
+    count -= chunk;
+  }
+  return ans;
+}
 
-    try {
-      new_outer[_alloc_count - 1] = reinterpret_cast<T*>(new char[sizeof(T) * _inner_size]);
-    } catch (...) {
-      delete[] reinterpret_cast<char**>(new_outer);
-      throw;
+template <typename T>
+void Deque<T>::commit_back(size_t count)
+  requires std::is_trivially_copyable_v<T> {
+  size_t free_count = (_size == 0) ? _inner_size : _inner_size - 1 - _inner_last_index;
+  if (count >= free_count + _spare_back * _inner_size) {
+    throw std::length_error(std::to_string(count) + " elements were not reserved");
+  }
+  _commit_back(count);
+}
+
+template <typename T>
+void Deque<T>::_commit_back(size_t count) {
+  if (count == 0) {
+    return;
+  }
+
+  size_t inner_index = (_size == 0) ? 0 : _inner_last_index + 1;
+  size_t new_blocks = (inner_index + count - 1) / _inner_size;
+
+  if (_size == 0) {
+    _inner_first_index = 0;
+  }
+  _last_alloc_index += new_blocks;
+  _spare_back -= new_blocks;
+  _alloc_count += new_blocks;
+  _inner_last_index = (inner_index + count - 1) % _inner_size;
+  _size += count;
+}
+
+template <typename T>
+template <typename InputIt>
+void Deque<T>::append(InputIt first, InputIt last) {
+  if constexpr (!std::forward_iterator<InputIt>) {
+    for (; first != last; ++first) {
+      push_back(*first);
+    }
+  } else {
+    size_t count = static_cast<size_t>(std::distance(first, last));
+    if (count == 0) {
+      return;
     }
 
-    try {
-      new (new_outer[_alloc_count - 1] + _inner_size - 1) T(value);
-    } catch (...) {
-      delete[] reinterpret_cast<char*>(new_outer[_alloc_count - 1]);
-      delete[] reinterpret_cast<char**>(new_outer);
-      throw;
+    size_t inner_index = (_size == 0) ? 0 : _inner_last_index + 1;
+    size_t free_count = _inner_size - inner_index;
+    size_t new_blocks = 0;
+    if (count >= free_count) {
+      new_blocks = (count - free_count + _inner_size) / _inner_size;
     }
 
-    delete[] reinterpret_cast<char**>(_outer);
-    _outer = new_outer;
-    _first_alloc_index = _alloc_count - 1;
-    _last_alloc_index += _alloc_count;
-    _inner_first_index = _inner_size - 1;
-    _outer_size += _alloc_count;
-    ++_alloc_count;
+    _ensure_back_blocks(new_blocks);
+
+    size_t outer_index = _last_alloc_index;
+    if (inner_index == _inner_size) {
+      ++outer_index;
+      inner_index = 0;
+    }
+    _copy_to_blocks(outer_index, inner_index, first, count);
+    _commit_back(count);
   }
+}
 
-  ++_size;
+template <typename T>
+void Deque<T>::append(std::span<const T> values) {
+  append(values.begin(), values.end());
+}
+
+template <typename T>
+template <typename InputIt>
+void Deque<T>::prepend(InputIt first, InputIt last) {
+  if constexpr (!std::forward_iterator<InputIt>) {
+    std::vector<T> values(first, last);
+    prepend(values.cbegin(), values.cend());
+  } else {
+    if (_size == 0) {
+      append(first, last);
+      return;
+    }
+
+    size_t count = static_cast<size_t>(std::distance(first, last));
+    if (count == 0) {
+      return;
+    }
+
+    size_t new_blocks = 0;
+    if (count > _inner_first_index) {
+      new_blocks = (count - _inner_first_index + _inner_size - 1) / _inner_size;
+    }
+
+    _ensure_front_blocks(new_blocks);
+
+    size_t inner_index = new_blocks * _inner_size + _inner_first_index - count;
+    _copy_to_blocks(_first_alloc_index - new_blocks, inner_index, first, count);
+
+    _first_alloc_index -= new_blocks;
+    _spare_front -= new_blocks;
+    _first_block_id -= static_cast<std::ptrdiff_t>(new_blocks);
+    _alloc_count += new_blocks;
+    _inner_first_index = inner_index;
+    _size += count;
+  }
+}
+
+template <typename T>
+void Deque<T>::prepend(std::span<const T> values) {
+  prepend(values.begin(), values.end());
 }
 
 template <typename T>
@@ -698,12 +1184,46 @@ const T& Deque<T>::at(size_t index) const {
   return operator[](index);
 }
 
+template <typename T>
+typename Deque<T>::Handle Deque<T>::handle(size_t index) const {
+  _iterator<true> it(index, this);
+  return Handle{_first_block_id + static_cast<std::ptrdiff_t>(it._outer_index - _first_alloc_index),
+                it._inner_index()};
+}
+
+template <typename T>
+typename Deque<T>::Handle Deque<T>::end_handle() const {
+  return handle(_size);
+}
+
+template <typename T>
+size_t Deque<T>::index(const Handle& handle) const {
+  return static_cast<size_t>(handle.block - _first_block_id) * _inner_size + handle.offset -
+         _inner_first_index;
+}
+
+template <typename T>
+T& Deque<T>::operator[](const Handle& handle) {
+  return _outer[_first_alloc_index + static_cast<size_t>(handle.block - _first_block_id)]
+               [handle.offset];
+}
+
+template <typename T>
+const T& Deque<T>::operator[](const Handle& handle) const {
+  return _outer[_first_alloc_index + static_cast<size_t>(handle.block - _first_block_id)]
+               [handle.offset];
+}
+
 template <typename T>
 void Deque<T>::pop_back() {
   (_outer[_last_alloc_index] + _inner_last_index)->~T();
   if (_inner_last_index == 0) {
     if (_last_alloc_index != _first_alloc_index) {
-      delete[] reinterpret_cast<char*>(_outer[_last_alloc_index]);
+      if (_spare_back > 0) {
+        _free_blocks(_last_alloc_index + _spare_back, 1);
+      } else {
+        ++_spare_back;
+      }
       --_last_alloc_index;
       _inner_last_index = _inner_size - 1;
       --_alloc_count;
@@ -719,8 +1239,13 @@ void Deque<T>::pop_front() {
   (_outer[_first_alloc_index] + _inner_first_index)->~T();
   if (_inner_first_index == _inner_size - 1) {
     if (_last_alloc_index != _first_alloc_index) {
-      delete[] reinterpret_cast<char*>(_outer[_first_alloc_index]);
+      if (_spare_front > 0) {
+        _free_blocks(_first_alloc_index - _spare_front, 1);
+      } else {
+        ++_spare_front;
+      }
       ++_first_alloc_index;
+      ++_first_block_id;
       --_alloc_count;
     }
     _inner_first_index = 0;
@@ -730,27 +1255,107 @@ void Deque<T>::pop_front() {
   --_size;
 }
 
+template <typename T>
+template <typename OutputIt>
+OutputIt Deque<T>::pop_back_n(size_t count, OutputIt out) {
+  count = std::min(count, _size);
+  if (count == 0) {
+    return out;
+  }
+
+  _iterator<false> first = end() - static_cast<std::ptrdiff_t>(count);
+  _for_each_segment(first, end(), [&out](std::span<T> segment) {
+    out = std::move(segment.begin(), segment.end(), out);
+    return true;
+  });
+  _for_each_segment(first, end(), [](std::span<T> segment) {
+    std::destroy(segment.begin(), segment.end());
+    return true;
+  });
+
+  _size -= count;
+  size_t last_alloc_index = _first_alloc_index;
+  if (_size > 0) {
+    size_t position = _inner_first_index + _size - 1;
+    last_alloc_index += position / _inner_size;
+    _inner_last_index = position % _inner_size;
+  } else {
+    _inner_first_index = 0;
+    _inner_last_index = 0;
+  }
+
+  size_t emptied = _last_alloc_index - last_alloc_index;
+  if (emptied > 0) {
+    size_t spare_count = std::max<size_t>(_spare_back, 1);
+    _free_blocks(last_alloc_index + 1 + spare_count, emptied + _spare_back - spare_count);
+    _spare_back = spare_count;
+    _last_alloc_index = last_alloc_index;
+    _alloc_count -= emptied;
+  }
+  return out;
+}
+
+template <typename T>
+template <typename OutputIt>
+OutputIt Deque<T>::pop_front_n(size_t count, OutputIt out) {
+  count = std::min(count, _size);
+  if (count == 0) {
+    return out;
+  }
+
+  _iterator<false> last = begin() + static_cast<std::ptrdiff_t>(count);
+  _for_each_segment(begin(), last, [&out](std::span<T> segment) {
+    out = std::move(segment.begin(), segment.end(), out);
+    return true;
+  });
+  _for_each_segment(begin(), last, [](std::span<T> segment) {
+    std::destroy(segment.begin(), segment.end());
+    return true;
+  });
+
+  size_t position = _inner_first_index + count;
+  size_t emptied = std::min(position / _inner_size, _alloc_count - 1);
+  _size -= count;
+  if (_size > 0) {
+    _inner_first_index = position - emptied * _inner_size;
+  } else {
+    _inner_first_index = 0;
+    _inner_last_index = 0;
+  }
+
+  if (emptied > 0) {
+    size_t spare_count = std::max<size_t>(_spare_front, 1);
+    _free_blocks(_first_alloc_index - _spare_front, emptied + _spare_front - spare_count);
+    _spare_front = spare_count;
+    _first_alloc_index += emptied;
+    _first_block_id += static_cast<std::ptrdiff_t>(emptied);
+    _alloc_count -= emptied;
+  }
+  return out;
+}
+
 template <typename T>
 typename Deque<T>::template _iterator<false> Deque<T>::insert(const _iterator<true>& it,
   const T& value) {
 
   push_back(value);
-  for (_iterator<false> it1 = end() - 1; it1 != it; --it1) {
-    new (_outer[it1._outer_index] + it1._inner_index) T(*((it1 - 1)._current));
+  _iterator<false> pos(it._index, this);
+  for (_iterator<false> it1 = end() - 1; it1 != pos; --it1) {
+    new (it1._current) T(*((it1 - 1)._current));
   }
 
   if (_size != 1) {
-    new (_outer[it._outer_index] + it._inner_index) T(value);
+    new (pos._current) T(value);
   }
 
-  return _iterator<false>(it._index, this);
+  return pos;
 }
 
 template <typename T>
 typename Deque<T>::template _iterator<false> Deque<T>::erase(const _iterator<true>& it) {
   _iterator<false> it1(it._index, this);
   for (; it1 != end() - 1; ++it1) {
-    new (_outer[it1._outer_index] + it1._inner_index) T(*((it1 + 1)._current));
+    new (it1._current) T(*((it1 + 1)._current));
   }
   pop_back();
 
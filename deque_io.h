@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "deque.h"
+
+inline const size_t _iov_max = [] {
+#ifdef IOV_MAX
+  return static_cast<size_t>(IOV_MAX);
+#else
+  long limit = ::sysconf(_SC_IOV_MAX);
+  return limit > 0 ? static_cast<size_t>(limit) : size_t{1024};
+#endif
+}();
+
+template <typename T>
+std::vector<iovec> deque_iovecs(const Deque<T>& deque) {
+  static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable elements can be exported");
+
+  std::vector<iovec> ans;
+  deque.for_each_segment([&ans](std::span<const T> segment) {
+    ans.push_back({const_cast<T*>(segment.data()), segment.size_bytes()});
+  });
+  return ans;
+}
+
+template <typename T>
+ssize_t write_deque(int fd, const Deque<T>& deque) {
+  std::vector<iovec> iovecs = deque_iovecs(deque);
+
+  ssize_t total = 0;
+  size_t i = 0;
+  while (i < iovecs.size()) {
+    int count = static_cast<int>(std::min(iovecs.size() - i, _iov_max));
+    ssize_t written = ::writev(fd, iovecs.data() + i, count);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return total > 0 ? total : -1;
+    }
+    total += written;
+
+    size_t left = static_cast<size_t>(written);
+    for (; i < iovecs.size() && left >= iovecs[i].iov_len; ++i) {
+      left -= iovecs[i].iov_len;
+    }
+    if (left > 0) {
+      iovecs[i].iov_base = static_cast<char*>(iovecs[i].iov_base) + left;
+      iovecs[i].iov_len -= left;
+    }
+  }
+  return total;
+}
+
+template <typename T>
+ssize_t read_deque(int fd, Deque<T>& deque, size_t count, size_t& partial_bytes) {
+  static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable elements can be imported");
+
+  if (count == 0) {
+    return 0;
+  }
+
+  std::vector<iovec> iovecs;
+  for (std::span<T> segment : deque.free_back_segments(count)) {
+    iovecs.push_back({segment.data(), segment.size_bytes()});
+  }
+  iovecs[0].iov_base = static_cast<char*>(iovecs[0].iov_base) + partial_bytes;
+  iovecs[0].iov_len -= partial_bytes;
+
+  size_t total = 0;
+  size_t i = 0;
+  while (i < iovecs.size()) {
+    int iov_count = static_cast<int>(std::min(iovecs.size() - i, _iov_max));
+    size_t requested = 0;
+    for (int k = 0; k < iov_count; ++k) {
+      requested += iovecs[i + k].iov_len;
+    }
+    ssize_t received = ::readv(fd, iovecs.data() + i, iov_count);
+    if (received < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (total == 0) {
+        return -1;
+      }
+      break;
+    }
+    if (received == 0) {
+      break;
+    }
+    total += static_cast<size_t>(received);
+
+    size_t left = static_cast<size_t>(received);
+    for (; i < iovecs.size() && left >= iovecs[i].iov_len; ++i) {
+      left -= iovecs[i].iov_len;
+    }
+    if (left > 0) {
+      iovecs[i].iov_base = static_cast<char*>(iovecs[i].iov_base) + left;
+      iovecs[i].iov_len -= left;
+    }
+
+    if (static_cast<size_t>(received) < requested) {
+      break;
+    }
+  }
+
+  total += partial_bytes;
+  partial_bytes = total % sizeof(T);
+  deque.commit_back(total / sizeof(T));
+  return static_cast<ssize_t>(total / sizeof(T));
+}
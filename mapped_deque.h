@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+template <typename T>
+class MappedDeque {
+  static_assert(std::is_trivially_copyable_v<T>, "elements are stored as raw bytes in the file");
+  static_assert(alignof(T) <= 64, "elements must fit the header alignment");
+
+ public:
+  explicit MappedDeque(const std::string& path);
+
+  MappedDeque(const MappedDeque<T>& deque) = delete;
+
+  MappedDeque<T>& operator=(const MappedDeque<T>& deque) = delete;
+
+  ~MappedDeque() noexcept;
+
+  size_t size() const;
+
+  bool empty() const;
+
+  void push_back(const T& value);
+
+  void pop_front();
+
+  T& operator[](size_t index);
+
+  const T& operator[](size_t index) const;
+
+  T& at(size_t index);
+
+  const T& at(size_t index) const;
+
+  void sync();
+
+ private:
+  struct _Header {
+    uint64_t magic;
+    uint64_t element_size;
+    uint64_t head;
+    uint64_t tail;
+  };
+
+  void _map(size_t file_size);
+  void _grow();
+  T* _data() const;
+
+  static const uint64_t _magic;
+  static const size_t _data_offset;
+  static const size_t _block_size;
+  static const size_t _reserve_size;
+
+  int _fd = -1;
+  char* _map_ptr = nullptr;
+  size_t _map_size = 0;
+  size_t _reserved_size = 0;
+  size_t _capacity = 0;
+  _Header* _header = nullptr;
+};
+
+template <typename T>
+const uint64_t MappedDeque<T>::_magic = 0x4d41505044455155;
+
+template <typename T>
+const size_t MappedDeque<T>::_data_offset = 64;
+
+template <typename T>
+const size_t MappedDeque<T>::_block_size = 4096;
+
+template <typename T>
+const size_t MappedDeque<T>::_reserve_size = size_t{1} << 30;
+
+template <typename T>
+MappedDeque<T>::MappedDeque(const std::string& path) {
+  _fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (_fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "open " + path);
+  }
+
+  try {
+    struct stat st;
+    if (::fstat(_fd, &st) != 0) {
+      throw std::system_error(errno, std::generic_category(), "fstat " + path);
+    }
+
+    size_t file_size = static_cast<size_t>(st.st_size);
+    bool is_new = (file_size == 0);
+    if (is_new) {
+      file_size = _data_offset + sizeof(T) * _block_size;
+      if (::ftruncate(_fd, static_cast<off_t>(file_size)) != 0) {
+        throw std::system_error(errno, std::generic_category(), "ftruncate " + path);
+      }
+    } else if (file_size < _data_offset) {
+      throw std::runtime_error(path + " is too small to be a MappedDeque file");
+    }
+
+    _map(file_size);
+
+    if (is_new) {
+      *_header = _Header{_magic, sizeof(T), 0, 0};
+    } else if (_header->magic != _magic || _header->element_size != sizeof(T) ||
+               _header->head > _header->tail || _header->tail > _capacity) {
+      throw std::runtime_error(path + " is not a MappedDeque file for this element type");
+    }
+  } catch (...) {
+    if (_map_ptr != nullptr) {
+      ::munmap(_map_ptr, _reserved_size);
+    }
+    ::close(_fd);
+    throw;
+  }
+}
+
+template <typename T>
+MappedDeque<T>::~MappedDeque() noexcept {
+  ::munmap(_map_ptr, _reserved_size);
+  ::close(_fd);
+}
+
+template <typename T>
+void MappedDeque<T>::_map(size_t file_size) {
+  size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  size_t reserved_size = std::max(_reserve_size, 2 * file_size);
+  reserved_size = (reserved_size + page_size - 1) / page_size * page_size;
+
+  void* base = ::mmap(nullptr, reserved_size, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (base == MAP_FAILED) {
+    throw std::system_error(errno, std::generic_category(), "mmap");
+  }
+
+  void* ptr = ::mmap(base, file_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, _fd, 0);
+  if (ptr == MAP_FAILED) {
+    int error = errno;
+    ::munmap(base, reserved_size);
+    throw std::system_error(error, std::generic_category(), "mmap");
+  }
+
+  _map_ptr = static_cast<char*>(base);
+  _map_size = file_size;
+  _reserved_size = reserved_size;
+  _capacity = (file_size - _data_offset) / sizeof(T);
+  _header = reinterpret_cast<_Header*>(_map_ptr);
+}
+
+template <typename T>
+void MappedDeque<T>::_grow() {
+  size_t file_size = _data_offset + sizeof(T) * (_capacity + _block_size);
+  if (::ftruncate(_fd, static_cast<off_t>(file_size)) != 0) {
+    throw std::system_error(errno, std::generic_category(), "ftruncate");
+  }
+
+  if (file_size > _reserved_size) {
+    char* old_ptr = _map_ptr;
+    size_t old_size = _reserved_size;
+    _map(file_size);
+    ::munmap(old_ptr, old_size);
+    return;
+  }
+
+  size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  size_t from = _map_size / page_size * page_size;
+  void* ptr = ::mmap(_map_ptr + from, file_size - from, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_FIXED, _fd, static_cast<off_t>(from));
+  if (ptr == MAP_FAILED) {
+    throw std::system_error(errno, std::generic_category(), "mmap");
+  }
+
+  _map_size = file_size;
+  _capacity = (file_size - _data_offset) / sizeof(T);
+}
+
+template <typename T>
+T* MappedDeque<T>::_data() const {
+  return reinterpret_cast<T*>(_map_ptr + _data_offset);
+}
+
+template <typename T>
+size_t MappedDeque<T>::size() const {
+  return static_cast<size_t>(_header->tail - _header->head);
+}
+
+template <typename T>
+bool MappedDeque<T>::empty() const {
+  return size() == 0;
+}
+
+template <typename T>
+void MappedDeque<T>::push_back(const T& value) {
+  if (_header->tail == _capacity) {
+    T copy = value;
+    _grow();
+    new (_data() + _header->tail) T(copy);
+  } else {
+    new (_data() + _header->tail) T(value);
+  }
+  ++_header->tail;
+}
+
+template <typename T>
+void MappedDeque<T>::pop_front() {
+  ++_header->head;
+}
+
+template <typename T>
+T& MappedDeque<T>::operator[](size_t index) {
+  return _data()[_header->head + index];
+}
+
+template <typename T>
+const T& MappedDeque<T>::operator[](size_t index) const {
+  return _data()[_header->head + index];
+}
+
+template <typename T>
+T& MappedDeque<T>::at(size_t index) {
+  if (index >= size()) {
+    throw std::out_of_range(std::to_string(index) + " >= " + std::to_string(size()));
+  }
+  return operator[](index);
+}
+
+template <typename T>
+const T& MappedDeque<T>::at(size_t index) const {
+  if (index >= size()) {
+    throw std::out_of_range(std::to_string(index) + " >= " + std::to_string(size()));
+  }
+  return operator[](index);
+}
+
+template <typename T>
+void MappedDeque<T>::sync() {
+  if (::msync(_map_ptr, _map_size, MS_SYNC) != 0) {
+    throw std::system_error(errno, std::generic_category(), "msync");
+  }
+}
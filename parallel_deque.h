@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "thread_pool.h"
+
+template <typename Segment, typename Func>
+void run_segment_chunks(ThreadPool& pool, const std::vector<Segment>& segments, size_t size,
+                        Func func) {
+  size_t chunk_size = std::max<size_t>(size / (4 * pool.thread_count()), 1);
+
+  TaskGroup group(pool);
+  size_t chunk_index = 0;
+  size_t first = 0;
+  size_t offset = 0;
+  size_t count = 0;
+  for (size_t i = 0; i < segments.size(); ++i) {
+    count += segments[i].size();
+    if (count < chunk_size && i + 1 != segments.size()) {
+      continue;
+    }
+
+    std::span<const Segment> chunk(segments.data() + first, i + 1 - first);
+    group.run([&func, chunk_index, offset, chunk] { func(chunk_index, offset, chunk); });
+    ++chunk_index;
+    first = i + 1;
+    offset += count;
+    count = 0;
+  }
+  group.wait();
+}
+
+template <typename T, typename Func>
+void parallel_for_each(ThreadPool& pool, Deque<T>& deque, Func func) {
+  run_segment_chunks(pool, deque.segments(), deque.size(),
+                     [&func](size_t, size_t, std::span<const std::span<T>> chunk) {
+    for (std::span<T> segment : chunk) {
+      std::for_each(segment.begin(), segment.end(), func);
+    }
+  });
+}
+
+template <typename T, typename UnaryOp>
+void parallel_transform(ThreadPool& pool, Deque<T>& deque, UnaryOp op) {
+  run_segment_chunks(pool, deque.segments(), deque.size(),
+                     [&op](size_t, size_t, std::span<const std::span<T>> chunk) {
+    for (std::span<T> segment : chunk) {
+      std::transform(segment.begin(), segment.end(), segment.begin(), op);
+    }
+  });
+}
+
+template <typename T, typename Init, typename BinaryOp = std::plus<>>
+Init parallel_reduce(ThreadPool& pool, const Deque<T>& deque, Init init,
+                     BinaryOp op = BinaryOp()) {
+  std::vector<std::span<const T>> segments = deque.segments();
+  std::vector<std::optional<Init>> partial(segments.size());
+
+  run_segment_chunks(pool, segments, deque.size(),
+                     [&op, &partial](size_t chunk_index, size_t,
+                                     std::span<const std::span<const T>> chunk) {
+    std::optional<Init> value;
+    for (std::span<const T> segment : chunk) {
+      auto it = segment.begin();
+      if (!value && it != segment.end()) {
+        value.emplace(*it++);
+      }
+      if (value) {
+        *value = std::accumulate(it, segment.end(), std::move(*value), op);
+      }
+    }
+    partial[chunk_index] = std::move(value);
+  });
+
+  for (std::optional<Init>& value : partial) {
+    if (value) {
+      init = op(std::move(init), std::move(*value));
+    }
+  }
+  return init;
+}
+
+template <typename T, typename Compare = std::less<>>
+void parallel_sort(ThreadPool& pool, Deque<T>& deque, Compare comp = Compare()) {
+  std::vector<T> buffer;
+  buffer.reserve(deque.size());
+  deque.for_each_segment([&buffer](std::span<T> segment) {
+    std::move(segment.begin(), segment.end(), std::back_inserter(buffer));
+  });
+
+  size_t run_size = std::max<size_t>(buffer.size() / pool.thread_count(), 1);
+  {
+    TaskGroup group(pool);
+    for (size_t first = 0; first < buffer.size(); first += run_size) {
+      size_t last = std::min(first + run_size, buffer.size());
+      group.run([&buffer, &comp, first, last] {
+        std::sort(buffer.begin() + first, buffer.begin() + last, comp);
+      });
+    }
+    group.wait();
+  }
+
+  for (; run_size < buffer.size(); run_size *= 2) {
+    TaskGroup group(pool);
+    for (size_t first = 0; first + run_size < buffer.size(); first += 2 * run_size) {
+      size_t middle = first + run_size;
+      size_t last = std::min(first + 2 * run_size, buffer.size());
+      group.run([&buffer, &comp, first, middle, last] {
+        std::inplace_merge(buffer.begin() + first, buffer.begin() + middle,
+                           buffer.begin() + last, comp);
+      });
+    }
+    group.wait();
+  }
+
+  run_segment_chunks(pool, deque.segments(), deque.size(),
+                     [&buffer](size_t, size_t offset, std::span<const std::span<T>> chunk) {
+    for (std::span<T> segment : chunk) {
+      std::move(buffer.begin() + offset, buffer.begin() + offset + segment.size(),
+                segment.begin());
+      offset += segment.size();
+    }
+  });
+}
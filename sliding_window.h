@@ -0,0 +1,164 @@
+#pragma once
+
+#include <functional>
+#include <iterator>
+#include <span>
+
+#include "deque.h"
+
+template <typename T, typename Compare = std::less<T>>
+class SlidingWindow {
+ public:
+  explicit SlidingWindow(size_t window_size, const Compare& comp = Compare())
+    : _window_size(window_size), _comp(comp) {}
+
+  size_t window_size() const;
+
+  size_t size() const;
+
+  bool empty() const;
+
+  void push(const T& value);
+
+  template <typename InputIt>
+  void push(InputIt first, InputIt last);
+
+  void push(std::span<const T> values);
+
+  void pop();
+
+  void clear();
+
+  const T& sum() const;
+
+  const T& min() const;
+
+  const T& max() const;
+
+  const T& operator[](size_t index) const;
+
+ private:
+  void _add(const T& value);
+
+  size_t _window_size;
+  [[no_unique_address]] Compare _comp;
+
+  Deque<T> _values;
+  Deque<T> _min_values;
+  Deque<T> _max_values;
+  T _sum{};
+};
+
+template <typename T, typename Compare>
+size_t SlidingWindow<T, Compare>::window_size() const {
+  return _window_size;
+}
+
+template <typename T, typename Compare>
+size_t SlidingWindow<T, Compare>::size() const {
+  return _values.size();
+}
+
+template <typename T, typename Compare>
+bool SlidingWindow<T, Compare>::empty() const {
+  return _values.size() == 0;
+}
+
+template <typename T, typename Compare>
+void SlidingWindow<T, Compare>::_add(const T& value) {
+  while (_min_values.size() > 0 && _comp(value, _min_values[_min_values.size() - 1])) {
+    _min_values.pop_back();
+  }
+  _min_values.push_back(value);
+
+  while (_max_values.size() > 0 && _comp(_max_values[_max_values.size() - 1], value)) {
+    _max_values.pop_back();
+  }
+  _max_values.push_back(value);
+
+  _sum += value;
+}
+
+template <typename T, typename Compare>
+void SlidingWindow<T, Compare>::push(const T& value) {
+  if (_window_size == 0) {
+    return;
+  }
+  if (_values.size() == _window_size) {
+    pop();
+  }
+  _values.push_back(value);
+  _add(value);
+}
+
+template <typename T, typename Compare>
+template <typename InputIt>
+void SlidingWindow<T, Compare>::push(InputIt first, InputIt last) {
+  if constexpr (!std::forward_iterator<InputIt>) {
+    for (; first != last; ++first) {
+      push(*first);
+    }
+  } else {
+    size_t count = static_cast<size_t>(std::distance(first, last));
+    if (count >= _window_size) {
+      clear();
+      std::advance(first, count - _window_size);
+      count = _window_size;
+    }
+
+    while (_values.size() + count > _window_size) {
+      pop();
+    }
+
+    _values.append(first, last);
+    for (; first != last; ++first) {
+      _add(*first);
+    }
+  }
+}
+
+template <typename T, typename Compare>
+void SlidingWindow<T, Compare>::push(std::span<const T> values) {
+  push(values.begin(), values.end());
+}
+
+template <typename T, typename Compare>
+void SlidingWindow<T, Compare>::pop() {
+  const T& value = _values[0];
+  if (!_comp(_min_values[0], value) && !_comp(value, _min_values[0])) {
+    _min_values.pop_front();
+  }
+  if (!_comp(_max_values[0], value) && !_comp(value, _max_values[0])) {
+    _max_values.pop_front();
+  }
+  _sum -= value;
+  _values.pop_front();
+}
+
+template <typename T, typename Compare>
+void SlidingWindow<T, Compare>::clear() {
+  _values.clear(false);
+  _min_values.clear(false);
+  _max_values.clear(false);
+  _sum = T{};
+}
+
+template <typename T, typename Compare>
+const T& SlidingWindow<T, Compare>::sum() const {
+  return _sum;
+}
+
+template <typename T, typename Compare>
+const T& SlidingWindow<T, Compare>::min() const {
+  return _min_values[0];
+}
+
+template <typename T, typename Compare>
+const T& SlidingWindow<T, Compare>::max() const {
+  return _max_values[0];
+}
+
+template <typename T, typename Compare>
+const T& SlidingWindow<T, Compare>::operator[](size_t index) const {
+  return _values[index];
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+template <typename T>
+class SpscDeque {
+ public:
+  explicit SpscDeque(size_t capacity);
+
+  SpscDeque(const SpscDeque<T>& deque) = delete;
+
+  SpscDeque<T>& operator=(const SpscDeque<T>& deque) = delete;
+
+  ~SpscDeque() noexcept;
+
+  size_t capacity() const;
+
+  size_t size() const;
+
+  bool empty() const;
+
+  bool push_back(const T& value);
+
+  bool pop_front(T& value);
+
+  template <typename InputIt>
+  size_t push_back_n(InputIt first, size_t count);
+
+  template <typename OutputIt>
+  size_t pop_front_n(size_t count, OutputIt out);
+
+ private:
+  T* _slot(size_t index) const;
+
+  static const size_t _inner_size;
+
+  T** _outer;
+  size_t _outer_size;
+  size_t _capacity;
+  size_t _mask;
+
+  alignas(64) std::atomic<size_t> _head{0};
+  size_t _cached_tail = 0;
+
+  alignas(64) std::atomic<size_t> _tail{0};
+  size_t _cached_head = 0;
+};
+
+template <typename T>
+const size_t SpscDeque<T>::_inner_size = 32;
+
+template <typename T>
+SpscDeque<T>::SpscDeque(size_t capacity)
+  : _outer_size(std::bit_ceil((capacity + _inner_size - 1) / _inner_size)) {
+  if (capacity == 0) {
+    throw std::invalid_argument("capacity must be positive");
+  }
+  _capacity = _outer_size * _inner_size;
+  _mask = _capacity - 1;
+  _outer = reinterpret_cast<T**>(new char[sizeof(T*) * _outer_size]);
+
+  size_t i = 0;
+  try {
+    for (; i < _outer_size; ++i) {
+      _outer[i] = reinterpret_cast<T*>(new char[sizeof(T) * _inner_size]);
+    }
+  } catch (...) {
+    for (; i--;) {
+      delete[] reinterpret_cast<char*>(_outer[i]);
+    }
+    delete[] reinterpret_cast<char**>(_outer);
+    throw;
+  }
+}
+
+template <typename T>
+SpscDeque<T>::~SpscDeque() noexcept {
+  size_t tail = _tail.load(std::memory_order_relaxed);
+  for (size_t i = _head.load(std::memory_order_relaxed); i != tail; ++i) {
+    _slot(i)->~T();
+  }
+
+  for (size_t i = 0; i < _outer_size; ++i) {
+    delete[] reinterpret_cast<char*>(_outer[i]);
+  }
+  delete[] reinterpret_cast<char**>(_outer);
+}
+
+template <typename T>
+T* SpscDeque<T>::_slot(size_t index) const {
+  index &= _mask;
+  return _outer[index / _inner_size] + index % _inner_size;
+}
+
+template <typename T>
+size_t SpscDeque<T>::capacity() const {
+  return _capacity;
+}
+
+template <typename T>
+size_t SpscDeque<T>::size() const {
+  size_t head = _head.load(std::memory_order_acquire);
+  return _tail.load(std::memory_order_acquire) - head;
+}
+
+template <typename T>
+bool SpscDeque<T>::empty() const {
+  return size() == 0;
+}
+
+template <typename T>
+bool SpscDeque<T>::push_back(const T& value) {
+  return push_back_n(&value, 1) == 1;
+}
+
+template <typename T>
+bool SpscDeque<T>::pop_front(T& value) {
+  return pop_front_n(1, &value) == 1;
+}
+
+template <typename T>
+template <typename InputIt>
+size_t SpscDeque<T>::push_back_n(InputIt first, size_t count) {
+  size_t tail = _tail.load(std::memory_order_relaxed);
+  if (tail - _cached_head + count > _capacity) {
+    _cached_head = _head.load(std::memory_order_acquire);
+  }
+  count = std::min(count, _capacity - (tail - _cached_head));
+
+  size_t done = 0;
+  try {
+    for (; done < count; ++done, ++first) {
+      new (_slot(tail + done)) T(*first);
+    }
+  } catch (...) {
+    _tail.store(tail + done, std::memory_order_release);
+    throw;
+  }
+
+  _tail.store(tail + done, std::memory_order_release);
+  return done;
+}
+
+template <typename T>
+template <typename OutputIt>
+size_t SpscDeque<T>::pop_front_n(size_t count, OutputIt out) {
+  size_t head = _head.load(std::memory_order_relaxed);
+  if (_cached_tail - head < count) {
+    _cached_tail = _tail.load(std::memory_order_acquire);
+  }
+  count = std::min(count, _cached_tail - head);
+
+  size_t done = 0;
+  try {
+    for (; done < count; ++done, ++out) {
+      T* slot = _slot(head + done);
+      *out = std::move(*slot);
+      slot->~T();
+    }
+  } catch (...) {
+    _head.store(head + done, std::memory_order_release);
+    throw;
+  }
+
+  _head.store(head + done, std::memory_order_release);
+  return done;
+}
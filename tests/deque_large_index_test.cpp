@@ -0,0 +1,92 @@
+// Needs about 4 GB of memory, so it is not part of any default run.
+// g++ -std=c++20 -O2 tests/deque_large_index_test.cpp -o deque_large_index_test
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../deque.h"
+
+static int failures = 0;
+
+#define CHECK(condition)                                                   \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, \
+                   #condition);                                            \
+      ++failures;                                                          \
+    }                                                                      \
+  } while (false)
+
+static char pattern(size_t index) {
+  return static_cast<char>((index * 2654435761u) >> 24);
+}
+
+int main(int argc, char** argv) {
+  const size_t boundary = size_t{1} << 31;
+  size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : boundary + 4099;
+  if (size <= boundary + 64) {
+    std::fprintf(stderr, "size must exceed 2^31 + 64\n");
+    return 2;
+  }
+
+  Deque<char> deque(size, 0);
+  CHECK(deque.size() == size);
+
+  const size_t window = 200;
+  for (size_t i = boundary - window; i < boundary + window && i < size; ++i) {
+    deque[i] = pattern(i);
+  }
+  deque[size - 1] = pattern(size - 1);
+
+  for (size_t i = boundary - window; i < boundary + window && i < size; ++i) {
+    CHECK(deque[i] == pattern(i));
+    CHECK(deque.at(i) == pattern(i));
+  }
+
+  auto begin = deque.begin();
+  auto end = deque.end();
+  CHECK(end - begin == static_cast<std::ptrdiff_t>(size));
+  CHECK(begin - end == -static_cast<std::ptrdiff_t>(size));
+
+  for (size_t i = boundary - window; i < boundary + window; ++i) {
+    auto it = begin + static_cast<std::ptrdiff_t>(i);
+    CHECK(*it == pattern(i));
+    CHECK(it - begin == static_cast<std::ptrdiff_t>(i));
+    CHECK(end - it == static_cast<std::ptrdiff_t>(size - i));
+  }
+
+  auto it = begin;
+  it += static_cast<std::ptrdiff_t>(boundary);
+  CHECK(*it == pattern(boundary));
+  it -= 1;
+  CHECK(*it == pattern(boundary - 1));
+  it += 2;
+  CHECK(*it == pattern(boundary + 1));
+  it -= static_cast<std::ptrdiff_t>(boundary);
+  CHECK(it - begin == 1);
+
+  it = end;
+  it -= static_cast<std::ptrdiff_t>(size - boundary);
+  CHECK(*it == pattern(boundary));
+  it += -static_cast<std::ptrdiff_t>(boundary);
+  CHECK(it == begin);
+  it -= -static_cast<std::ptrdiff_t>(size - 1);
+  CHECK(*it == pattern(size - 1));
+
+  auto last = end - 1;
+  CHECK(*last == pattern(size - 1));
+  CHECK(last > begin + static_cast<std::ptrdiff_t>(boundary));
+
+  deque.push_back(pattern(size));
+  deque.push_front(pattern(0));
+  CHECK(deque.size() == size + 2);
+  CHECK(deque[boundary + 1] == pattern(boundary));
+  CHECK(deque[size + 1] == pattern(size));
+
+  if (failures != 0) {
+    std::fprintf(stderr, "%d checks failed\n", failures);
+    return 1;
+  }
+  std::printf("ok: %zu elements\n", size);
+  return 0;
+}
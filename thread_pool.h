@@ -0,0 +1,260 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "deque.h"
+#include "work_stealing_deque.h"
+
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t thread_count = std::thread::hardware_concurrency());
+
+  ThreadPool(const ThreadPool& pool) = delete;
+
+  ThreadPool& operator=(const ThreadPool& pool) = delete;
+
+  ~ThreadPool() noexcept;
+
+  size_t thread_count() const;
+
+  // Exceptions thrown by func are discarded; use TaskGroup::run to observe them.
+  template <typename Func>
+  void submit(Func&& func);
+
+  bool run_pending_task();
+
+ private:
+  using Task = std::function<void()>;
+
+  void _worker_loop(size_t index);
+  void _shutdown() noexcept;
+  Task* _take_task();
+
+  inline static thread_local ThreadPool* _current_pool = nullptr;
+  inline static thread_local size_t _current_index = 0;
+
+  std::vector<WorkStealingDeque<Task*>*> _queues;
+  std::vector<std::thread> _threads;
+
+  std::mutex _injected_mutex;
+  Deque<Task*> _injected;
+  std::atomic<size_t> _injected_size{0};
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::atomic<size_t> _queued{0};
+  std::atomic<size_t> _sleeping{0};
+  bool _stop = false;
+};
+
+class TaskGroup {
+ public:
+  explicit TaskGroup(ThreadPool& pool): _pool(pool) {}
+
+  TaskGroup(const TaskGroup& group) = delete;
+
+  TaskGroup& operator=(const TaskGroup& group) = delete;
+
+  ~TaskGroup() noexcept;
+
+  template <typename Func>
+  void run(Func&& func);
+
+  void wait();
+
+ private:
+  void _help_until_done();
+
+  ThreadPool& _pool;
+  std::atomic<size_t> _pending{0};
+  std::mutex _exception_mutex;
+  std::exception_ptr _exception;
+};
+
+inline ThreadPool::ThreadPool(size_t thread_count) {
+  thread_count = std::max<size_t>(thread_count, 1);
+  try {
+    _queues.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+      _queues.push_back(new WorkStealingDeque<Task*>());
+    }
+    for (size_t i = 0; i < thread_count; ++i) {
+      _threads.emplace_back(&ThreadPool::_worker_loop, this, i);
+    }
+  } catch (...) {
+    _shutdown();
+    throw;
+  }
+}
+
+inline ThreadPool::~ThreadPool() noexcept {
+  _shutdown();
+}
+
+inline void ThreadPool::_shutdown() noexcept {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _cv.notify_all();
+
+  for (std::thread& thread : _threads) {
+    thread.join();
+  }
+  _threads.clear();
+
+  for (WorkStealingDeque<Task*>* queue : _queues) {
+    delete queue;
+  }
+  _queues.clear();
+}
+
+inline size_t ThreadPool::thread_count() const {
+  return _queues.size();
+}
+
+template <typename Func>
+void ThreadPool::submit(Func&& func) {
+  std::unique_ptr<Task> task = std::make_unique<Task>(std::forward<Func>(func));
+  _queued.fetch_add(1);
+
+  try {
+    if (_current_pool == this) {
+      _queues[_current_index]->push_back(task.get());
+    } else {
+      std::lock_guard<std::mutex> lock(_injected_mutex);
+      _injected.push_back(task.get());
+      _injected_size.fetch_add(1, std::memory_order_release);
+    }
+  } catch (...) {
+    _queued.fetch_sub(1);
+    throw;
+  }
+  task.release();
+
+  if (_sleeping.load() > 0) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cv.notify_one();
+  }
+}
+
+inline bool ThreadPool::run_pending_task() {
+  std::unique_ptr<Task> task(_take_task());
+  if (task == nullptr) {
+    return false;
+  }
+
+  try {
+    (*task)();
+  } catch (...) {
+  }
+  return true;
+}
+
+inline ThreadPool::Task* ThreadPool::_take_task() {
+  if (_current_pool == this) {
+    if (std::optional<Task*> task = _queues[_current_index]->pop_back()) {
+      _queued.fetch_sub(1);
+      return *task;
+    }
+  }
+
+  if (_injected_size.load(std::memory_order_acquire) > 0) {
+    std::lock_guard<std::mutex> lock(_injected_mutex);
+    if (_injected.size() > 0) {
+      Task* task = _injected[0];
+      _injected.pop_front();
+      _injected_size.fetch_sub(1, std::memory_order_relaxed);
+      _queued.fetch_sub(1);
+      return task;
+    }
+  }
+
+  size_t start = (_current_pool == this) ? _current_index + 1 : 0;
+  for (size_t i = 0; i < _queues.size(); ++i) {
+    size_t victim = (start + i) % _queues.size();
+    if (_current_pool == this && victim == _current_index) {
+      continue;
+    }
+    if (std::optional<Task*> task = _queues[victim]->steal()) {
+      _queued.fetch_sub(1);
+      return *task;
+    }
+  }
+
+  return nullptr;
+}
+
+inline void ThreadPool::_worker_loop(size_t index) {
+  _current_pool = this;
+  _current_index = index;
+
+  while (true) {
+    if (run_pending_task()) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _sleeping.fetch_add(1);
+    _cv.wait(lock, [this] { return _stop || _queued.load() > 0; });
+    _sleeping.fetch_sub(1);
+    if (_stop && _queued.load() == 0) {
+      return;
+    }
+  }
+}
+
+inline TaskGroup::~TaskGroup() noexcept {
+  _help_until_done();
+}
+
+template <typename Func>
+void TaskGroup::run(Func&& func) {
+  _pending.fetch_add(1, std::memory_order_relaxed);
+  try {
+    _pool.submit([this, func = std::forward<Func>(func)]() mutable {
+      try {
+        func();
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(_exception_mutex);
+        if (!_exception) {
+          _exception = std::current_exception();
+        }
+      }
+      _pending.fetch_sub(1, std::memory_order_release);
+    });
+  } catch (...) {
+    _pending.fetch_sub(1, std::memory_order_relaxed);
+    throw;
+  }
+}
+
+inline void TaskGroup::wait() {
+  _help_until_done();
+
+  std::exception_ptr exception;
+  {
+    std::lock_guard<std::mutex> lock(_exception_mutex);
+    std::swap(exception, _exception);
+  }
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+inline void TaskGroup::_help_until_done() {
+  while (_pending.load(std::memory_order_acquire) != 0) {
+    if (!_pool.run_pending_task()) {
+      std::this_thread::yield();
+    }
+  }
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+template <typename T>
+class WorkStealingDeque {
+  static_assert(std::is_trivially_copyable_v<T>, "elements are stored in std::atomic slots");
+
+ public:
+  explicit WorkStealingDeque(size_t capacity = 32);
+
+  WorkStealingDeque(const WorkStealingDeque<T>& deque) = delete;
+
+  WorkStealingDeque<T>& operator=(const WorkStealingDeque<T>& deque) = delete;
+
+  ~WorkStealingDeque() noexcept;
+
+  size_t size() const;
+
+  bool empty() const;
+
+  void push_back(const T& value);
+
+  std::optional<T> pop_back();
+
+  std::optional<T> steal();
+
+ private:
+  class _Buffer {
+   public:
+    explicit _Buffer(size_t capacity)
+      : _capacity(capacity), _slots(new std::atomic<T>[capacity]) {}
+
+    ~_Buffer() noexcept {
+      delete[] _slots;
+    }
+
+    size_t capacity() const {
+      return _capacity;
+    }
+
+    T load(ptrdiff_t index) const {
+      return _slots[static_cast<size_t>(index) & (_capacity - 1)].load(std::memory_order_relaxed);
+    }
+
+    void store(ptrdiff_t index, const T& value) {
+      _slots[static_cast<size_t>(index) & (_capacity - 1)].store(value, std::memory_order_relaxed);
+    }
+
+    _Buffer* grow(ptrdiff_t top, ptrdiff_t bottom) const {
+      _Buffer* buffer = new _Buffer(2 * _capacity);
+      for (ptrdiff_t i = top; i != bottom; ++i) {
+        buffer->store(i, load(i));
+      }
+      return buffer;
+    }
+
+   private:
+    size_t _capacity;
+    std::atomic<T>* _slots;
+  };
+
+  alignas(64) std::atomic<ptrdiff_t> _top{0};
+  alignas(64) std::atomic<ptrdiff_t> _bottom{0};
+  std::atomic<_Buffer*> _buffer;
+  std::vector<_Buffer*> _retired;
+};
+
+template <typename T>
+WorkStealingDeque<T>::WorkStealingDeque(size_t capacity) {
+  size_t power = 1;
+  while (power < capacity) {
+    power *= 2;
+  }
+  _buffer.store(new _Buffer(power), std::memory_order_relaxed);
+}
+
+template <typename T>
+WorkStealingDeque<T>::~WorkStealingDeque() noexcept {
+  for (_Buffer* buffer : _retired) {
+    delete buffer;
+  }
+  delete _buffer.load(std::memory_order_relaxed);
+}
+
+template <typename T>
+size_t WorkStealingDeque<T>::size() const {
+  ptrdiff_t bottom = _bottom.load(std::memory_order_relaxed);
+  ptrdiff_t top = _top.load(std::memory_order_relaxed);
+  return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+}
+
+template <typename T>
+bool WorkStealingDeque<T>::empty() const {
+  return size() == 0;
+}
+
+template <typename T>
+void WorkStealingDeque<T>::push_back(const T& value) {
+  ptrdiff_t bottom = _bottom.load(std::memory_order_relaxed);
+  ptrdiff_t top = _top.load(std::memory_order_acquire);
+  _Buffer* buffer = _buffer.load(std::memory_order_relaxed);
+
+  if (static_cast<size_t>(bottom - top) >= buffer->capacity()) {
+    _retired.reserve(_retired.size() + 1);
+    _Buffer* new_buffer = buffer->grow(top, bottom);
+    _retired.push_back(buffer);
+    buffer = new_buffer;
+    _buffer.store(buffer, std::memory_order_release);
+  }
+
+  buffer->store(bottom, value);
+  std::atomic_thread_fence(std::memory_order_release);
+  _bottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+template <typename T>
+std::optional<T> WorkStealingDeque<T>::pop_back() {
+  ptrdiff_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+  _Buffer* buffer = _buffer.load(std::memory_order_relaxed);
+  _bottom.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  ptrdiff_t top = _top.load(std::memory_order_relaxed);
+
+  if (top > bottom) {
+    _bottom.store(bottom + 1, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+
+  T value = buffer->load(bottom);
+  if (top == bottom) {
+    bool won = _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                            std::memory_order_relaxed);
+    _bottom.store(bottom + 1, std::memory_order_relaxed);
+    if (!won) {
+      return std::nullopt;
+    }
+  }
+  return value;
+}
+
+template <typename T>
+std::optional<T> WorkStealingDeque<T>::steal() {
+  ptrdiff_t top = _top.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  ptrdiff_t bottom = _bottom.load(std::memory_order_acquire);
+
+  if (top >= bottom) {
+    return std::nullopt;
+  }
+
+  _Buffer* buffer = _buffer.load(std::memory_order_acquire);
+  T value = buffer->load(top);
+  if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed)) {
+    return std::nullopt;
+  }
+  return value;
+}